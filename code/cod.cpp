@@ -1,6 +1,7 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <array>
 #include <string>
 #include <algorithm>
 #include <random>
@@ -10,15 +11,48 @@
 #include <sstream>
 #include <thread>
 #include <mutex>
+#include <memory>
+#include <new>
+#include <variant>
+#include <type_traits>
+#include <map>
+#include <tuple>
+#include <future>
+#include <atomic>
 #include <cassert>
 #include <cstdlib>
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <cstdint>
+#include <charconv>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2 1
+#include <immintrin.h>
+#endif
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #if __cplusplus >= 201703L
 #include <filesystem>
 namespace fs = std::filesystem;
 #endif
 
-// Structures de donnes
+// Structures de données
 struct Produit {
     int id;
     double poids;
@@ -31,87 +65,813 @@ struct Ville {
     std::string nom;
 };
 
+// Fichier projeté en mémoire (lecture seule), libéré à la destruction
+class FichierMappe {
+public:
+    FichierMappe() = default;
+    FichierMappe(const FichierMappe&) = delete;
+    FichierMappe& operator=(const FichierMappe&) = delete;
+    ~FichierMappe() { fermer(); }
+
+    bool ouvrir(const std::string& fichier) {
+        fermer();
+#ifdef _WIN32
+        hFichier = CreateFileA(fichier.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (hFichier == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER tailleFichier;
+        if (!GetFileSizeEx(hFichier, &tailleFichier)) { fermer(); return false; }
+        tailleDonnees = static_cast<size_t>(tailleFichier.QuadPart);
+        if (tailleDonnees == 0) return true;
+        hProjection = CreateFileMappingA(hFichier, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!hProjection) { fermer(); return false; }
+        donnees = static_cast<const char*>(MapViewOfFile(hProjection, FILE_MAP_READ, 0, 0, 0));
+        if (!donnees) { fermer(); return false; }
+#else
+        int fd = ::open(fichier.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat infos;
+        if (fstat(fd, &infos) != 0) { ::close(fd); return false; }
+        tailleDonnees = static_cast<size_t>(infos.st_size);
+        if (tailleDonnees > 0) {
+            void* adresse = mmap(nullptr, tailleDonnees, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (adresse == MAP_FAILED) { ::close(fd); tailleDonnees = 0; return false; }
+            donnees = static_cast<const char*>(adresse);
+            madvise(adresse, tailleDonnees, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+#endif
+        return true;
+    }
+
+    // Pour un fichier utilisé en place avec des lectures dispersées (matrice binaire)
+    void conseillerAccesAleatoire() {
+#ifndef _WIN32
+        if (donnees) madvise(const_cast<char*>(donnees), tailleDonnees, MADV_RANDOM);
+#endif
+    }
+
+    void fermer() {
+#ifdef _WIN32
+        if (donnees) UnmapViewOfFile(donnees);
+        if (hProjection) CloseHandle(hProjection);
+        if (hFichier != INVALID_HANDLE_VALUE) CloseHandle(hFichier);
+        hProjection = nullptr;
+        hFichier = INVALID_HANDLE_VALUE;
+#else
+        if (donnees) munmap(const_cast<char*>(donnees), tailleDonnees);
+#endif
+        donnees = nullptr;
+        tailleDonnees = 0;
+    }
+
+    const char* debut() const { return donnees; }
+    const char* fin() const { return donnees + tailleDonnees; }
+    size_t taille() const { return tailleDonnees; }
+
+private:
+    const char* donnees = nullptr;
+    size_t tailleDonnees = 0;
+#ifdef _WIN32
+    HANDLE hFichier = INVALID_HANDLE_VALUE;
+    HANDLE hProjection = nullptr;
+#endif
+};
+
+// Découpe un tampon en lignes sans copie (retire le '\r' final éventuel)
+class LecteurLignes {
+public:
+    LecteurLignes(const char* debut, const char* fin) : pos(debut), fin(fin) {}
+
+    bool suivante(std::string_view& ligne) {
+        if (pos == fin) return false;
+        const char* finLigne = static_cast<const char*>(std::memchr(pos, '\n', fin - pos));
+        if (!finLigne) finLigne = fin;
+        const char* finUtile = finLigne;
+        if (finUtile > pos && finUtile[-1] == '\r') --finUtile;
+        ligne = std::string_view(pos, finUtile - pos);
+        pos = (finLigne == fin) ? fin : finLigne + 1;
+        return true;
+    }
+
+    const char* position() const { return pos; }
+
+private:
+    const char* pos;
+    const char* fin;
+};
+
+inline const char* sauterEspaces(const char* p, const char* fin) {
+    while (p < fin && (*p == ' ' || *p == '\t')) ++p;
+    return p;
+}
+
+// Lit un nombre avec std::from_chars en sautant les blancs qui le précèdent ;
+// un '+' initial est accepté et nan/inf sont refusés, comme avec l'opérateur >> des flux
+template <typename T>
+bool lireNombre(const char*& p, const char* fin, T& valeur) {
+    p = sauterEspaces(p, fin);
+    if (p < fin && *p == '+') {
+        ++p;
+        if (p < fin && *p == '-') return false;
+    }
+    auto res = std::from_chars(p, fin, valeur);
+    if (res.ec != std::errc()) return false;
+    if constexpr (std::is_floating_point_v<T>) {
+        if (!std::isfinite(valeur)) return false;
+    }
+    p = res.ptr;
+    return true;
+}
+
+inline bool lireSeparateur(const char*& p, const char* fin, char separateur) {
+    p = sauterEspaces(p, fin);
+    if (p == fin || *p != separateur) return false;
+    ++p;
+    return true;
+}
+
+// Matrice carrée stockée par lignes dans un tampon unique aligné sur 64 octets ;
+// chaque ligne est complétée par des zéros jusqu'à un multiple de 64 octets (LARGEUR_SIMD doubles).
+constexpr size_t ALIGNEMENT_MATRICE = 64;
+constexpr size_t LARGEUR_SIMD = ALIGNEMENT_MATRICE / sizeof(double);
+
+// Les matrices peuvent stocker des double, des float ou des entiers 16 bits quantifiés
+// (valeur = entier * echelle). Le type est un paramètre des vues : les algorithmes sont
+// instanciés pour chaque type et la conversion se réduit à une instruction par lecture.
+enum class Precision {
+    Double,
+    Float,
+    Quantifie16
+};
+
+template <typename T>
+inline double decoderEnergie(T valeur, double echelle) {
+    if constexpr (std::is_integral_v<T>) return valeur * echelle;
+    else return static_cast<double>(valeur);
+}
+
+template <typename T>
+inline T encoderEnergie(double valeur, double echelle) {
+    if constexpr (std::is_integral_v<T>) return static_cast<T>(std::lround(valeur / echelle));
+    else return static_cast<T>(valeur);
+}
+
+// Rassemble ligne[villes[k]] pour k dans [0, nb) (AVX2, option CMake ACTIVER_AVX2 : quatre lectures indexées par instruction)
+inline void rassemblerEnergies(const double* ligne, const int* villes, size_t nb, double* sortie) {
+    size_t k = 0;
+#if defined(__AVX2__)
+    for (; k + 4 <= nb; k += 4) {
+        const __m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i*>(villes + k));
+        _mm256_storeu_pd(sortie + k, _mm256_i32gather_pd(ligne, indices, 8));
+    }
+#endif
+    for (; k < nb; ++k) sortie[k] = ligne[villes[k]];
+}
+
+// Vue non propriétaire sur une matrice dense : E(i, j) ou E.ligne(i)[j]
+template <typename T>
+struct VueMatriceDense {
+    const T* donnees = nullptr;
+    size_t n = 0;
+    size_t pas = 0;
+    double echelle = 1.0;
+
+    double operator()(int i, int j) const { return decoderEnergie(donnees[static_cast<size_t>(i) * pas + j], echelle); }
+    const T* ligne(int i) const { return donnees + static_cast<size_t>(i) * pas; }
+    size_t taille() const { return n; }
+
+    // Énergies de i vers toutes les villes ; tampon (n doubles) n'est utilisé que si la ligne n'est pas stockée en double
+    const double* ligneEnergies(int i, double* tampon) const {
+        if constexpr (std::is_same_v<T, double>) {
+            return ligne(i);
+        }
+        else {
+            const T* l = ligne(i);
+            for (size_t j = 0; j < n; ++j) tampon[j] = decoderEnergie(l[j], echelle);
+            return tampon;
+        }
+    }
+
+    // Énergies de i vers les seules villes villes[0 .. nb)
+    void energiesVers(int i, const int* villes, size_t nb, double* sortie) const {
+        if constexpr (std::is_same_v<T, double>) {
+            rassemblerEnergies(ligne(i), villes, nb, sortie);
+        }
+        else {
+            const T* l = ligne(i);
+            for (size_t k = 0; k < nb; ++k) sortie[k] = decoderEnergie(l[villes[k]], echelle);
+        }
+    }
+};
+
+using VueMatrice = VueMatriceDense<double>;
+
+template <typename T>
+class MatriceDense {
+public:
+    // Alloue une matrice n x n remise à zéro (padding compris)
+    void redimensionner(size_t taille) {
+        constexpr size_t largeur = ALIGNEMENT_MATRICE / sizeof(T);
+        projection.reset();
+        n = taille;
+        pas = (taille + largeur - 1) / largeur * largeur;
+        const size_t nbElements = n * pas;
+        tampon.reset(nbElements ? static_cast<T*>(::operator new[](nbElements * sizeof(T), std::align_val_t(ALIGNEMENT_MATRICE))) : nullptr);
+        if (nbElements) std::memset(tampon.get(), 0, nbElements * sizeof(T));
+        donnees = tampon.get();
+    }
+
+    // Utilise directement des lignes déjà présentes en mémoire (fichier binaire projeté), sans copie
+    void projeter(std::shared_ptr<const void> proprietaire, const T* debut, size_t taille, size_t pasLignes) {
+        tampon.reset();
+        projection = std::move(proprietaire);
+        donnees = debut;
+        n = taille;
+        pas = pasLignes;
+    }
+
+    // Accès en écriture, réservé au chargement d'une matrice allouée par redimensionner()
+    T* ligne(size_t i) { return tampon.get() + i * pas; }
+
+    void liberer() {
+        tampon.reset();
+        projection.reset();
+        donnees = nullptr;
+        n = pas = 0;
+    }
+
+    VueMatriceDense<T> vue() const { return { donnees, n, pas, echelle }; }
+    size_t taille() const { return n; }
+
+    double echelle = 1.0;
+
+private:
+    struct LibererAligne {
+        void operator()(T* p) const { ::operator delete[](p, std::align_val_t(ALIGNEMENT_MATRICE)); }
+    };
+
+    std::unique_ptr<T[], LibererAligne> tampon;
+    std::shared_ptr<const void> projection;
+    const T* donnees = nullptr;
+    size_t n = 0;
+    size_t pas = 0;
+};
+
+using MatriceEnergie = MatriceDense<double>;
+
+// Matrice symétrique : seul le triangle supérieur (j >= i) est conservé, ligne après ligne.
+// debutLignes[a] + b donne la position de (a, b) pour a <= b ; min/max évitent tout branchement.
+template <typename T>
+struct VueMatriceTriangulaire {
+    const T* donnees = nullptr;
+    const size_t* debutLignes = nullptr;
+    size_t n = 0;
+    double echelle = 1.0;
+
+    double operator()(int i, int j) const {
+        const int a = std::min(i, j);
+        const int b = std::max(i, j);
+        return decoderEnergie(donnees[debutLignes[a] + b], echelle);
+    }
+    size_t taille() const { return n; }
+
+    const double* ligneEnergies(int i, double* tampon) const {
+        for (int j = 0; j < i; ++j) tampon[j] = decoderEnergie(donnees[debutLignes[j] + i], echelle);
+        const T* l = donnees + debutLignes[i];
+        for (size_t j = i; j < n; ++j) tampon[j] = decoderEnergie(l[j], echelle);
+        return tampon;
+    }
+
+    void energiesVers(int i, const int* villes, size_t nb, double* sortie) const {
+        for (size_t k = 0; k < nb; ++k) sortie[k] = (*this)(i, villes[k]);
+    }
+};
+
+// Distances euclidiennes de (xi, yi) vers les points [0, n) (SSE2/AVX quand disponibles)
+inline void distancesDepuis(double xi, double yi, const double* x, const double* y, size_t n, double* sortie) {
+    size_t k = 0;
+#if defined(__AVX__)
+    const __m256d vxi = _mm256_set1_pd(xi);
+    const __m256d vyi = _mm256_set1_pd(yi);
+    for (; k + 4 <= n; k += 4) {
+        const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + k), vxi);
+        const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + k), vyi);
+        _mm256_storeu_pd(sortie + k, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+    }
+#elif defined(SIMD_SSE2)
+    const __m128d vxi = _mm_set1_pd(xi);
+    const __m128d vyi = _mm_set1_pd(yi);
+    for (; k + 2 <= n; k += 2) {
+        const __m128d dx = _mm_sub_pd(_mm_loadu_pd(x + k), vxi);
+        const __m128d dy = _mm_sub_pd(_mm_loadu_pd(y + k), vyi);
+        _mm_storeu_pd(sortie + k, _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy))));
+    }
+#endif
+    for (; k < n; ++k) {
+        const double dx = x[k] - xi;
+        const double dy = y[k] - yi;
+        sortie[k] = std::sqrt(dx * dx + dy * dy);
+    }
+}
+
+// Distances euclidiennes de (xi, yi) vers les points villes[k], k dans [0, nb) (AVX2 quand disponible)
+inline void distancesVers(double xi, double yi, const double* x, const double* y, const int* villes, size_t nb, double* sortie) {
+    size_t k = 0;
+#if defined(__AVX2__)
+    const __m256d vxi = _mm256_set1_pd(xi);
+    const __m256d vyi = _mm256_set1_pd(yi);
+    for (; k + 4 <= nb; k += 4) {
+        const __m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i*>(villes + k));
+        const __m256d dx = _mm256_sub_pd(_mm256_i32gather_pd(x, indices, 8), vxi);
+        const __m256d dy = _mm256_sub_pd(_mm256_i32gather_pd(y, indices, 8), vyi);
+        _mm256_storeu_pd(sortie + k, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+    }
+#endif
+    for (; k < nb; ++k) {
+        const double dx = x[villes[k]] - xi;
+        const double dy = y[villes[k]] - yi;
+        sortie[k] = std::sqrt(dx * dx + dy * dy);
+    }
+}
+
+// Mise à jour d'une couche de programmation dynamique du sac à dos :
+// dst[c] = max(src[c], src[c - w] + v) pour c >= w, dst[c] = src[c] sinon (SSE2/AVX quand disponibles)
+inline void majMaxDecale(const double* src, double* dst, size_t taille, size_t w, double v) {
+    const size_t debut = std::min(w, taille);
+    std::copy(src, src + debut, dst);
+    size_t c = debut;
+#if defined(__AVX__)
+    const __m256d vv = _mm256_set1_pd(v);
+    for (; c + 4 <= taille; c += 4) {
+        _mm256_storeu_pd(dst + c, _mm256_max_pd(_mm256_loadu_pd(src + c), _mm256_add_pd(_mm256_loadu_pd(src + c - w), vv)));
+    }
+#elif defined(SIMD_SSE2)
+    const __m128d vv = _mm_set1_pd(v);
+    for (; c + 2 <= taille; c += 2) {
+        _mm_storeu_pd(dst + c, _mm_max_pd(_mm_loadu_pd(src + c), _mm_add_pd(_mm_loadu_pd(src + c - w), vv)));
+    }
+#endif
+    for (; c < taille; ++c) dst[c] = std::max(src[c], src[c - w] + v);
+}
+
+// Instance donnée par coordonnées : l'énergie est la distance euclidienne, calculée à la demande (mémoire O(N))
+struct VueCoordonnees {
+    const double* x = nullptr;
+    const double* y = nullptr;
+    size_t n = 0;
+
+    double operator()(int i, int j) const {
+        const double dx = x[j] - x[i];
+        const double dy = y[j] - y[i];
+        return std::sqrt(dx * dx + dy * dy);
+    }
+    size_t taille() const { return n; }
+
+    const double* ligneEnergies(int i, double* tampon) const {
+        distancesDepuis(x[i], y[i], x, y, n, tampon);
+        return tampon;
+    }
+
+    void energiesVers(int i, const int* villes, size_t nb, double* sortie) const {
+        distancesVers(x[i], y[i], x, y, villes, nb, sortie);
+    }
+};
+
+struct CoordonneesVilles {
+    std::vector<double> x;
+    std::vector<double> y;
+
+    VueCoordonnees vue() const { return { x.data(), y.data(), x.size() }; }
+    size_t taille() const { return x.size(); }
+    void liberer() {
+        std::vector<double>().swap(x);
+        std::vector<double>().swap(y);
+    }
+};
+
+template <typename T>
+class MatriceTriangulaire {
+public:
+    void redimensionner(size_t taille) {
+        n = taille;
+        debutLignes.resize(n);
+        size_t position = 0;
+        for (size_t a = 0; a < n; ++a) {
+            debutLignes[a] = position - a;
+            position += n - a;
+        }
+        valeurs.assign(position, T());
+    }
+
+    void liberer() {
+        std::vector<T>().swap(valeurs);
+        std::vector<size_t>().swap(debutLignes);
+        n = 0;
+    }
+
+    // Écriture de (i, j) avec i <= j
+    T& element(size_t i, size_t j) { return valeurs[debutLignes[i] + j]; }
+    const T& element(size_t i, size_t j) const { return valeurs[debutLignes[i] + j]; }
+
+    VueMatriceTriangulaire<T> vue() const { return { valeurs.data(), debutLignes.data(), n, echelle }; }
+    size_t taille() const { return n; }
+
+    double echelle = 1.0;
+
+private:
+    std::vector<T> valeurs;
+    std::vector<size_t> debutLignes;
+    size_t n = 0;
+};
+
+enum class ModeStockage {
+    Dense,          // matrice complète
+    Triangulaire,   // triangle supérieur uniquement, la matrice est supposée symétrique
+    Auto            // triangulaire si la matrice lue est symétrique
+};
+
+// Formats binaires (écrits par la commande "convert", projetés en mémoire au chargement)
+// Produits : en-tête puis nbProduits enregistrements ayant la disposition de Produit.
+// Villes   : en-tête, table des décalages des noms (nbVilles + 1), noms concaténés,
+//            puis la matrice en lignes de "pas" doubles, alignée sur 64 octets
+//            (même disposition que MatriceEnergie, ce qui permet de l'utiliser sans copie).
+constexpr uint32_t VERSION_FORMAT_BINAIRE = 1;
+constexpr char MAGIQUE_PRODUITS[4] = { 'T', 'P', '6', 'P' };
+constexpr char MAGIQUE_VILLES[4] = { 'T', 'P', '6', 'V' };
+constexpr size_t ALIGNEMENT_BINAIRE = ALIGNEMENT_MATRICE;
+
+struct EnteteBinaireProduits {
+    char magique[4];
+    uint32_t version;
+    uint64_t nbProduits;
+    double capacite;
+    uint64_t reserve;
+};
+
+struct EnteteBinaireVilles {
+    char magique[4];
+    uint32_t version;
+    uint64_t nbVilles;
+    uint64_t pas;
+    uint64_t decalageNoms;
+    uint64_t decalageMatrice;
+    uint64_t reserve[3];
+};
+
+static_assert(sizeof(Produit) == 32 && offsetof(Produit, poids) == 8, "Disposition de Produit inattendue pour le format binaire");
+static_assert(sizeof(EnteteBinaireProduits) == 32 && sizeof(EnteteBinaireVilles) == 64, "Taille d'en-tête binaire inattendue");
+
+inline size_t arrondirAlignement(size_t valeur, size_t alignement) {
+    return (valeur + alignement - 1) / alignement * alignement;
+}
+
+inline bool estFichierBinaire(const FichierMappe& fichier, const char (&magique)[4]) {
+    return fichier.taille() >= 8 && std::memcmp(fichier.debut(), magique, 4) == 0;
+}
+
+// Nombre de threads réellement utilisés par executerEnParallele (0 : autant que de coeurs)
+inline unsigned int nbThreadsEffectif(size_t nbTaches, unsigned int nbThreads) {
+    if (nbThreads == 0) nbThreads = std::max(1u, std::thread::hardware_concurrency());
+    return static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(nbThreads, nbTaches)));
+}
+
+// Exécute tache(i, t) pour i dans [0, nbTaches) sur un groupe fixe de threads (répartition dynamique),
+// t étant l'indice du thread dans [0, nbThreadsEffectif(nbTaches, nbThreads))
+template <typename Tache>
+void executerEnParalleleParThread(size_t nbTaches, unsigned int nbThreads, Tache&& tache) {
+    nbThreads = nbThreadsEffectif(nbTaches, nbThreads);
+    if (nbThreads <= 1) {
+        for (size_t i = 0; i < nbTaches; ++i) tache(i, 0u);
+        return;
+    }
+
+    std::atomic<size_t> suivante{ 0 };
+    auto travailleur = [&](unsigned int t) {
+        for (size_t i = suivante.fetch_add(1); i < nbTaches; i = suivante.fetch_add(1)) {
+            tache(i, t);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(nbThreads - 1);
+    for (unsigned int t = 1; t < nbThreads; ++t) threads.emplace_back(travailleur, t);
+    travailleur(0);
+    for (auto& t : threads) t.join();
+}
+
+// Barrière réutilisable entre les nbThreads threads d'un même executerEnParalleleParThread (attente
+// active avec yield : les phases synchronisées sont courtes et très nombreuses)
+class Barriere {
+public:
+    explicit Barriere(unsigned int nbThreads) : nbThreads(nbThreads) {}
+
+    void attendre() {
+        const unsigned int phaseCourante = phase.load(std::memory_order_acquire);
+        if (arrives.fetch_add(1, std::memory_order_acq_rel) + 1 == nbThreads) {
+            arrives.store(0, std::memory_order_relaxed);
+            phase.store(phaseCourante + 1, std::memory_order_release);
+            return;
+        }
+        while (phase.load(std::memory_order_acquire) == phaseCourante) std::this_thread::yield();
+    }
+
+private:
+    const unsigned int nbThreads;
+    std::atomic<unsigned int> arrives{ 0 };
+    std::atomic<unsigned int> phase{ 0 };
+};
+
+// Exécute tache(i) pour i dans [0, nbTaches) sur un groupe fixe de threads (répartition dynamique)
+template <typename Tache>
+void executerEnParallele(size_t nbTaches, unsigned int nbThreads, Tache&& tache) {
+    executerEnParalleleParThread(nbTaches, nbThreads, [&](size_t i, unsigned int) { tache(i); });
+}
+
+// Les M villes les plus proches parmi celles proposées, triées par (distance, indice) : insertion
+// en O(M) dans un tableau réutilisable, le résultat ne dépend pas de l'ordre des propositions
+class SelectionPlusProches {
+public:
+    void reinitialiser(int m) {
+        M = std::max(m, 0);
+        nb = 0;
+        if (static_cast<int>(villes.size()) < M) {
+            villes.resize(M);
+            distances.resize(M);
+        }
+    }
+
+    void proposer(int v, double d) {
+        if (M == 0 || (nb == M && !avant(d, v, M - 1))) return;
+        int k = (nb < M) ? nb++ : M - 1;
+        for (; k > 0 && avant(d, v, k - 1); --k) {
+            distances[k] = distances[k - 1];
+            villes[k] = villes[k - 1];
+        }
+        distances[k] = d;
+        villes[k] = v;
+    }
+
+    int taille() const { return nb; }
+    bool complete() const { return nb == M; }
+    int ville(int k) const { return villes[k]; }
+    double distance(int k) const { return distances[k]; }
+
+private:
+    bool avant(double d, int v, int k) const {
+        return d < distances[k] || (d == distances[k] && v < villes[k]);
+    }
+
+    std::vector<double> distances;
+    std::vector<int> villes;
+    int M = 0;
+    int nb = 0;
+};
+
+// K plus proches voisins de chaque ville, la ville elle-même exclue, par énergie croissante.
+// Stockage à plat : les voisins de i sont voisins[i * k, (i + 1) * k). Construites une fois au
+// chargement de l'instance, puis partagées en lecture seule par toutes les réplications.
+struct ListesVoisins {
+    int k = 0;
+    std::vector<int> voisins;
+
+    const int* de(int i) const { return voisins.data() + static_cast<size_t>(i) * k; }
+    size_t taille() const { return k > 0 ? voisins.size() / k : 0; }
+    void liberer() {
+        std::vector<int>().swap(voisins);
+        k = 0;
+    }
+};
+
+// Matrice quelconque : une ligne par tâche, O(N^2) au total
+template <typename Energie>
+void construireListesVoisins(const Energie& E, int k, unsigned int nbThreads, ListesVoisins& listes) {
+    const int n = static_cast<int>(E.taille());
+    listes.k = std::min(k, n - 1);
+    listes.voisins.assign(static_cast<size_t>(n) * std::max(listes.k, 0), 0);
+    if (listes.k <= 0) return;
+
+    const unsigned int nbThreadsUtilises = nbThreadsEffectif(n, nbThreads);
+    std::vector<std::vector<double>> tampons(nbThreadsUtilises, std::vector<double>(n));
+    std::vector<SelectionPlusProches> selections(nbThreadsUtilises);
+    executerEnParalleleParThread(n, nbThreadsUtilises, [&](size_t i, unsigned int t) {
+        const double* ligne = E.ligneEnergies(static_cast<int>(i), tampons[t].data());
+        SelectionPlusProches& selection = selections[t];
+        selection.reinitialiser(listes.k);
+        for (int j = 0; j < n; ++j) {
+            if (j != static_cast<int>(i)) selection.proposer(j, ligne[j]);
+        }
+        int* destination = listes.voisins.data() + i * listes.k;
+        for (int r = 0; r < listes.k; ++r) destination[r] = selection.ville(r);
+        });
+}
+
+// Coordonnées : grille d'environ deux villes par case, parcourue en anneaux autour de la ville
+// jusqu'à ce que les cases restantes soient toutes plus loin que le k-ième voisin trouvé
+inline void construireListesVoisins(const VueCoordonnees& C, int k, unsigned int nbThreads, ListesVoisins& listes) {
+    const int n = static_cast<int>(C.taille());
+    listes.k = std::min(k, n - 1);
+    listes.voisins.assign(static_cast<size_t>(n) * std::max(listes.k, 0), 0);
+    if (listes.k <= 0) return;
+
+    double xMin = C.x[0], xMax = C.x[0], yMin = C.y[0], yMax = C.y[0];
+    for (int i = 1; i < n; ++i) {
+        xMin = std::min(xMin, C.x[i]);
+        xMax = std::max(xMax, C.x[i]);
+        yMin = std::min(yMin, C.y[i]);
+        yMax = std::max(yMax, C.y[i]);
+    }
+    const int g = std::max(1, static_cast<int>(std::sqrt(n / 2.0)));
+    const double cote = std::max({ xMax - xMin, yMax - yMin, 1e-12 }) / g;
+    auto caseDe = [&](double v, double vMin) { return std::min(g - 1, static_cast<int>((v - vMin) / cote)); };
+
+    // Tri par case (comptage) : les villes de la case c sont villesCases[debutCases[c], debutCases[c + 1])
+    std::vector<int> debutCases(static_cast<size_t>(g) * g + 1, 0);
+    std::vector<int> caseVille(n);
+    for (int i = 0; i < n; ++i) {
+        caseVille[i] = caseDe(C.y[i], yMin) * g + caseDe(C.x[i], xMin);
+        ++debutCases[caseVille[i] + 1];
+    }
+    for (size_t c = 0; c + 1 < debutCases.size(); ++c) debutCases[c + 1] += debutCases[c];
+    std::vector<int> villesCases(n);
+    std::vector<int> remplissage(debutCases.begin(), debutCases.end() - 1);
+    for (int i = 0; i < n; ++i) villesCases[remplissage[caseVille[i]]++] = i;
+
+    const unsigned int nbThreadsUtilises = nbThreadsEffectif(n, nbThreads);
+    std::vector<SelectionPlusProches> selections(nbThreadsUtilises);
+    executerEnParalleleParThread(n, nbThreadsUtilises, [&](size_t i, unsigned int t) {
+        const int cx = caseVille[i] % g, cy = caseVille[i] / g;
+        SelectionPlusProches& selection = selections[t];
+        selection.reinitialiser(listes.k);
+        auto parcourirCase = [&](int x, int y) {
+            if (x < 0 || x >= g || y < 0 || y >= g) return;
+            const int c = y * g + x;
+            for (int p = debutCases[c]; p < debutCases[c + 1]; ++p) {
+                const int j = villesCases[p];
+                if (j != static_cast<int>(i)) selection.proposer(j, C(static_cast<int>(i), j));
+            }
+        };
+        for (int r = 0; r < g; ++r) {
+            if (r == 0) parcourirCase(cx, cy);
+            for (int d = -r; d < r; ++d) {
+                parcourirCase(cx + d, cy - r);
+                parcourirCase(cx + r, cy + d);
+                parcourirCase(cx - d, cy + r);
+                parcourirCase(cx - r, cy - d);
+            }
+            // Toute ville d'un anneau plus lointain est à au moins r * cote de la ville i
+            if (selection.complete() && selection.distance(listes.k - 1) <= r * cote) break;
+        }
+        int* destination = listes.voisins.data() + i * listes.k;
+        for (int r = 0; r < listes.k; ++r) destination[r] = selection.ville(r);
+        });
+}
+
 class GestionDonnees {
 public:
     std::vector<Produit> produits;
+    std::vector<int> ordreRatio; // produits par ratio décroissant, partagé par toutes les réplications
     double capaciteMax;
     std::vector<Ville> villes;
-    std::vector<std::vector<double>> matriceEnergie;
+    MatriceEnergie matriceEnergie;
+    MatriceTriangulaire<double> matriceTriangulaire; // utilisée à la place de matriceEnergie en stockage triangulaire
+    CoordonneesVilles coordonnees;                   // instances "xy" : aucune matrice n'est stockée
+    // Copie en précision réduite, remplace les matrices double une fois le chargement terminé
+    std::variant<std::monostate, MatriceDense<float>, MatriceDense<uint16_t>,
+        MatriceTriangulaire<float>, MatriceTriangulaire<uint16_t>> matriceReduite;
+    ModeStockage modeStockage = ModeStockage::Dense;
+    Precision precision = Precision::Double;
+    bool matriceSymetrique = false;
+    unsigned int nbThreadsChargement = 0; // 0 : autant que de coeurs disponibles
+    ListesVoisins voisins;                // calculées en fin de lireVilles
+    int nbVoisins = 10;
+
+    VueMatrice energie() const { return matriceEnergie.vue(); }
+    bool stockageTriangulaire() const {
+        return matriceTriangulaire.taille() > 0 || std::holds_alternative<MatriceTriangulaire<float>>(matriceReduite)
+            || std::holds_alternative<MatriceTriangulaire<uint16_t>>(matriceReduite);
+    }
+    bool stockageCoordonnees() const { return coordonnees.taille() > 0; }
+
+    // Appelle f avec la vue correspondant au stockage courant ; le choix est fait une fois par appel,
+    // les accès E(i, j) dans f sont ensuite résolus à la compilation
+    template <typename F>
+    decltype(auto) avecEnergie(F&& f) const {
+        if (stockageCoordonnees()) return f(coordonnees.vue());
+        if (auto m = std::get_if<MatriceDense<float>>(&matriceReduite)) return f(m->vue());
+        if (auto m = std::get_if<MatriceDense<uint16_t>>(&matriceReduite)) return f(m->vue());
+        if (auto m = std::get_if<MatriceTriangulaire<float>>(&matriceReduite)) return f(m->vue());
+        if (auto m = std::get_if<MatriceTriangulaire<uint16_t>>(&matriceReduite)) return f(m->vue());
+        if (matriceTriangulaire.taille() > 0) return f(matriceTriangulaire.vue());
+        return f(matriceEnergie.vue());
+    }
 
     //Q2****
     bool lireProduits(const std::string& fichier) {
-        std::ifstream fin(fichier);
-        if (!fin) {
+        FichierMappe fichierMappe;
+        if (!fichierMappe.ouvrir(fichier)) {
             std::cerr << "Erreur: Impossible d'ouvrir le fichier " << fichier << std::endl;
             return false;
         }
 
-        std::string ligne;
-        if (!std::getline(fin, ligne)) {
+        if (estFichierBinaire(fichierMappe, MAGIQUE_PRODUITS)) {
+            return lireProduitsBinaire(fichierMappe, fichier);
+        }
+
+        LecteurLignes lecteur(fichierMappe.debut(), fichierMappe.fin());
+        std::string_view ligne;
+        if (!lecteur.suivante(ligne)) {
             std::cerr << "Erreur: Fichier vide ou format incorrect (ligne 1)" << std::endl;
             return false;
         }
 
-        std::istringstream iss(ligne);
+        const char* p = ligne.data();
+        const char* finLigne = p + ligne.size();
         int nbProduits;
         double capacite;
-        char delim;
-        if (!(iss >> nbProduits >> delim >> capacite) || delim != ';') {
+        if (!lireNombre(p, finLigne, nbProduits) || !lireSeparateur(p, finLigne, ';') || !lireNombre(p, finLigne, capacite)) {
             std::cerr << "Erreur: Format de fichier incorrect (ligne 1)" << std::endl;
             return false;
         }
 
         if (nbProduits <= 0 || capacite <= 0) {
-            std::cerr << "Erreur: Nombre de produits ou capacit invalide (ligne 1)" << std::endl;
+            std::cerr << "Erreur: Nombre de produits ou capacité invalide (ligne 1)" << std::endl;
             return false;
         }
 
         capaciteMax = capacite;
         produits.clear();
+        produits.reserve(nbProduits);
 
         for (int i = 0; i < nbProduits; ++i) {
-            if (!std::getline(fin, ligne)) {
+            if (!lecteur.suivante(ligne)) {
                 std::cerr << "Erreur: Nombre de lignes insuffisant pour les produits (attendu " << nbProduits << ")" << std::endl;
                 return false;
             }
 
-            std::istringstream issProduit(ligne);
-            Produit p;
-            if (!(issProduit >> p.id >> delim >> p.poids >> delim >> p.valeur) || delim != ';') {
+            p = ligne.data();
+            finLigne = p + ligne.size();
+            Produit prod;
+            if (!lireNombre(p, finLigne, prod.id) || !lireSeparateur(p, finLigne, ';')
+                || !lireNombre(p, finLigne, prod.poids) || !lireSeparateur(p, finLigne, ';')
+                || !lireNombre(p, finLigne, prod.valeur)) {
                 std::cerr << "Erreur: Format de fichier incorrect (ligne " << i + 2 << ")" << std::endl;
                 return false;
             }
 
-            if (p.poids <= 0 || p.valeur <= 0) {
-                std::cerr << "Erreur: Poids ou valeur invalide pour le produit ID " << p.id << " (ligne " << i + 2 << ")" << std::endl;
+            if (prod.poids <= 0 || prod.valeur <= 0) {
+                std::cerr << "Erreur: Poids ou valeur invalide pour le produit ID " << prod.id << " (ligne " << i + 2 << ")" << std::endl;
                 return false;
             }
 
-            p.ratio = p.valeur / p.poids;
-            produits.push_back(p);
+            prod.ratio = prod.valeur / prod.poids;
+            produits.push_back(prod);
         }
 
+        calculerOrdreRatio();
         return true;
     }
 
+    // Indices des produits par ratio décroissant (à ratio égal, par indice croissant)
+    static std::vector<int> trierParRatio(const std::vector<Produit>& produits) {
+        std::vector<int> ordre(produits.size());
+        for (size_t i = 0; i < ordre.size(); ++i) ordre[i] = static_cast<int>(i);
+        std::sort(ordre.begin(), ordre.end(), [&](int a, int b) {
+            return produits[a].ratio > produits[b].ratio || (produits[a].ratio == produits[b].ratio && a < b);
+            });
+        return ordre;
+    }
+
+    // Calculé une fois au chargement ; à rappeler si produits est modifié directement
+    void calculerOrdreRatio() { ordreRatio = trierParRatio(produits); }
+
+    // Sur le stockage final (précision réduite comprise), pour rester cohérent avec les tournées
+    void calculerVoisins() {
+        avecEnergie([&](const auto& E) { construireListesVoisins(E, nbVoisins, nbThreadsChargement, voisins); });
+    }
+
     bool lireVilles(const std::string& fichier) {
-        std::ifstream fin(fichier);
-        if (!fin) {
+        auto projection = std::make_shared<FichierMappe>();
+        FichierMappe& fichierMappe = *projection;
+        if (!fichierMappe.ouvrir(fichier)) {
             std::cerr << "Erreur: Impossible d'ouvrir le fichier " << fichier << std::endl;
             return false;
         }
 
-        std::string ligne;
-        if (!std::getline(fin, ligne)) {
+        if (estFichierBinaire(fichierMappe, MAGIQUE_VILLES)) {
+            return lireVillesBinaire(std::move(projection), fichier);
+        }
+
+        LecteurLignes lecteur(fichierMappe.debut(), fichierMappe.fin());
+        std::string_view ligne;
+        if (!lecteur.suivante(ligne)) {
             std::cerr << "Erreur: Fichier vide ou format incorrect (ligne 1)" << std::endl;
             return false;
         }
 
+        const char* p = ligne.data();
+        const char* finLigne = p + ligne.size();
         int nbVilles;
-        try {
-            nbVilles = std::stoi(ligne);
-        }
-        catch (...) {
+        if (!lireNombre(p, finLigne, nbVilles)) {
             std::cerr << "Erreur: Format de fichier incorrect (ligne 1)" << std::endl;
             return false;
         }
@@ -121,111 +881,2354 @@ public:
             return false;
         }
 
+        // Variante "<nb_villes> xy" : une ligne "nom;x;y" par ville, sans matrice
+        p = sauterEspaces(p, finLigne);
+        if (std::string_view(p, finLigne - p) == "xy") {
+            return lireVillesCoordonnees(lecteur, nbVilles);
+        }
+
         villes.clear();
+        villes.reserve(nbVilles);
         for (int i = 0; i < nbVilles; ++i) {
-            if (!std::getline(fin, ligne)) {
+            if (!lecteur.suivante(ligne)) {
                 std::cerr << "Erreur: Nombre de lignes insuffisant pour les villes (attendu " << nbVilles << ")" << std::endl;
                 return false;
             }
 
-            Ville v = { i, ligne };
+            Ville v = { i, std::string(ligne) };
             villes.push_back(v);
         }
 
-        matriceEnergie.resize(nbVilles, std::vector<double>(nbVilles));
-        for (int i = 0; i < nbVilles; ++i) {
-            if (!std::getline(fin, ligne)) {
-                std::cerr << "Erreur: Nombre de lignes insuffisant pour la matrice d'nergie (attendu " << nbVilles << ")" << std::endl;
-                return false;
+        // Repérage des lignes de la matrice en une passe, puis analyse parallèle par blocs de lignes
+        std::vector<std::string_view> lignesMatrice;
+        lignesMatrice.reserve(nbVilles);
+        while (static_cast<int>(lignesMatrice.size()) < nbVilles && lecteur.suivante(ligne)) {
+            lignesMatrice.push_back(ligne);
+        }
+
+        matriceTriangulaire.liberer();
+        matriceEnergie.liberer();
+        coordonnees.liberer();
+        matriceReduite = std::monostate();
+        // En mode auto, le texte est lu directement en triangle supérieur (sans copie dense) ; une
+        // matrice qui s'avère non symétrique est relue en stockage dense, le triangle une fois libéré
+        if (modeStockage == ModeStockage::Triangulaire || modeStockage == ModeStockage::Auto) {
+            matriceTriangulaire.redimensionner(nbVilles);
+        }
+        else {
+            matriceEnergie.redimensionner(nbVilles);
+        }
+        ErreurMatrice erreur = lireMatriceParallele(lignesMatrice, nbVilles);
+
+        if (erreur.ligne >= 0) {
+            if (erreur.colonne < 0) {
+                std::cerr << "Erreur: Format de matrice incorrect (ligne " << nbVilles + erreur.ligne + 2 << ")" << std::endl;
             }
+            else {
+                std::cerr << "Erreur: Valeur négative dans la matrice d'énergie (ligne " << nbVilles + erreur.ligne + 2 << ", colonne " << erreur.colonne + 1 << ")" << std::endl;
+            }
+            return false;
+        }
 
-            std::istringstream iss(ligne);
-            for (int j = 0; j < nbVilles; ++j) {
-                if (!(iss >> matriceEnergie[i][j])) {
-                    std::cerr << "Erreur: Format de matrice incorrect (ligne " << nbVilles + i + 2 << ")" << std::endl;
-                    return false;
-                }
+        if (static_cast<int>(lignesMatrice.size()) < nbVilles) {
+            std::cerr << "Erreur: Nombre de lignes insuffisant pour la matrice d'énergie (attendu " << nbVilles << ")" << std::endl;
+            return false;
+        }
 
-                if (matriceEnergie[i][j] < 0) {
-                    std::cerr << "Erreur: Valeur ngative dans la matrice d'nergie (ligne " << nbVilles + i + 2 << ", colonne " << j + 1 << ")" << std::endl;
-                    return false;
-                }
+        if (matriceTriangulaire.taille() > 0 && !triangleInferieurSymetrique(lignesMatrice)) {
+            if (modeStockage == ModeStockage::Auto) {
+                matriceTriangulaire.liberer();
+                matriceEnergie.redimensionner(nbVilles);
+                lireMatriceParallele(lignesMatrice, nbVilles);
+            }
+            else {
+                std::cerr << "Attention: matrice d'énergie non symétrique, seul le triangle supérieur est conservé" << std::endl;
             }
         }
 
+        appliquerModeStockage();
+        calculerVoisins();
         return true;
     }
-};
 
-class AlgorithmesGloutonsRandomises {
-private:
-    GestionDonnees& donnees;
-    std::mt19937 gen;
-    std::mutex mtx;
+    bool ecrireProduitsBinaire(const std::string& fichier) const {
+        std::ofstream fout(fichier, std::ios::binary);
+        if (!fout) {
+            std::cerr << "Erreur: Impossible d'ouvrir le fichier " << fichier << std::endl;
+            return false;
+        }
 
-    // Variables pour stocker les meilleures solutions
-    std::vector<Produit> meilleureSolutionP1;
-    std::vector<int> meilleureSolutionP2;
-    double meilleurScoreP1 = -std::numeric_limits<double>::infinity();
-    double meilleurScoreP2 = -std::numeric_limits<double>::infinity();
+        EnteteBinaireProduits entete{};
+        std::memcpy(entete.magique, MAGIQUE_PRODUITS, 4);
+        entete.version = VERSION_FORMAT_BINAIRE;
+        entete.nbProduits = produits.size();
+        entete.capacite = capaciteMax;
+        fout.write(reinterpret_cast<const char*>(&entete), sizeof(entete));
+        fout.write(reinterpret_cast<const char*>(produits.data()), produits.size() * sizeof(Produit));
+        return static_cast<bool>(fout);
+    }
 
-public:
-    AlgorithmesGloutonsRandomises(GestionDonnees& d, unsigned int graine) : donnees(d), gen(graine) {}
+    bool ecrireVillesBinaire(const std::string& fichier) const {
+        std::ofstream fout(fichier, std::ios::binary);
+        if (!fout) {
+            std::cerr << "Erreur: Impossible d'ouvrir le fichier " << fichier << std::endl;
+            return false;
+        }
 
+        const uint64_t nbVilles = villes.size();
+        std::vector<uint64_t> decalages(nbVilles + 1, 0);
+        for (size_t i = 0; i < nbVilles; ++i) {
+            decalages[i + 1] = decalages[i] + villes[i].nom.size();
+        }
 
+        EnteteBinaireVilles entete{};
+        std::memcpy(entete.magique, MAGIQUE_VILLES, 4);
+        entete.version = VERSION_FORMAT_BINAIRE;
+        entete.nbVilles = nbVilles;
+        entete.pas = arrondirAlignement(nbVilles, ALIGNEMENT_BINAIRE / sizeof(double));
+        entete.decalageNoms = sizeof(EnteteBinaireVilles);
+        entete.decalageMatrice = arrondirAlignement(entete.decalageNoms + decalages.size() * sizeof(uint64_t) + decalages.back(), ALIGNEMENT_BINAIRE);
 
-    //Q5****
-    std::vector<Produit> resoudreSacADosRandomise(int N = 2) {
-        auto produitsTries = donnees.produits;
-        std::sort(produitsTries.begin(), produitsTries.end(), [](const Produit& a, const Produit& b) {
-            return a.ratio > b.ratio;
-            });
+        fout.write(reinterpret_cast<const char*>(&entete), sizeof(entete));
+        fout.write(reinterpret_cast<const char*>(decalages.data()), decalages.size() * sizeof(uint64_t));
+        for (const auto& v : villes) fout.write(v.nom.data(), v.nom.size());
 
-        std::vector<Produit> solution;
-        double capaciteUtilisee = 0.0;
-        std::uniform_int_distribution<> dist(0, N - 1);
+        const size_t ecrits = entete.decalageNoms + decalages.size() * sizeof(uint64_t) + decalages.back();
+        const std::vector<char> bourrage(entete.decalageMatrice - ecrits, 0);
+        fout.write(bourrage.data(), bourrage.size());
 
-        for (size_t i = 0; i < produitsTries.size(); i += N) {
-            std::vector<Produit> candidats;
-            for (size_t j = i; j < i + N && j < produitsTries.size(); ++j) {
-                if (capaciteUtilisee + produitsTries[j].poids <= donnees.capaciteMax) {
-                    candidats.push_back(produitsTries[j]);
-                }
+        const VueMatrice D = energie();
+        if (!stockageTriangulaire() && D.pas == entete.pas) {
+            fout.write(reinterpret_cast<const char*>(D.donnees), nbVilles * D.pas * sizeof(double));
+            return static_cast<bool>(fout);
+        }
+
+        std::vector<double> ligne(entete.pas, 0.0);
+        avecEnergie([&](const auto& E) {
+            for (size_t i = 0; i < nbVilles; ++i) {
+                for (size_t j = 0; j < nbVilles; ++j) ligne[j] = E(static_cast<int>(i), static_cast<int>(j));
+                fout.write(reinterpret_cast<const char*>(ligne.data()), ligne.size() * sizeof(double));
             }
-            if (!candidats.empty()) {
-                int choix = dist(gen) % candidats.size();
-                solution.push_back(candidats[choix]);
-                capaciteUtilisee += candidats[choix].poids;
+            });
+        return static_cast<bool>(fout);
+    }
+
+private:
+    bool lireVillesCoordonnees(LecteurLignes& lecteur, int nbVilles) {
+        matriceTriangulaire.liberer();
+        matriceEnergie.liberer();
+        matriceReduite = std::monostate();
+        coordonnees.x.resize(nbVilles);
+        coordonnees.y.resize(nbVilles);
+        villes.clear();
+        villes.reserve(nbVilles);
+
+        std::string_view ligne;
+        for (int i = 0; i < nbVilles; ++i) {
+            if (!lecteur.suivante(ligne)) {
+                std::cerr << "Erreur: Nombre de lignes insuffisant pour les villes (attendu " << nbVilles << ")" << std::endl;
+                coordonnees.liberer();
+                return false;
+            }
+
+            const size_t separateur = ligne.find(';');
+            const char* p = ligne.data() + (separateur == std::string_view::npos ? ligne.size() : separateur);
+            const char* finLigne = ligne.data() + ligne.size();
+            if (separateur == std::string_view::npos || !lireSeparateur(p, finLigne, ';')
+                || !lireNombre(p, finLigne, coordonnees.x[i]) || !lireSeparateur(p, finLigne, ';')
+                || !lireNombre(p, finLigne, coordonnees.y[i])) {
+                std::cerr << "Erreur: Format de coordonnées incorrect (ligne " << i + 2 << ")" << std::endl;
+                coordonnees.liberer();
+                return false;
+            }
+
+            villes.push_back({ i, std::string(ligne.substr(0, separateur)) });
+        }
+
+        matriceSymetrique = true;
+        calculerVoisins();
+        return true;
+    }
+
+    bool lireProduitsBinaire(const FichierMappe& fichierMappe, const std::string& fichier) {
+        EnteteBinaireProduits entete;
+        if (fichierMappe.taille() < sizeof(entete)) {
+            std::cerr << "Erreur: En-tête binaire tronqué dans " << fichier << std::endl;
+            return false;
+        }
+        std::memcpy(&entete, fichierMappe.debut(), sizeof(entete));
+
+        if (entete.version != VERSION_FORMAT_BINAIRE) {
+            std::cerr << "Erreur: Version de format binaire non supportée (" << entete.version << ") dans " << fichier << std::endl;
+            return false;
+        }
+
+        if (entete.nbProduits == 0 || !(entete.capacite > 0) || !std::isfinite(entete.capacite)
+            || entete.nbProduits > (fichierMappe.taille() - sizeof(entete)) / sizeof(Produit)) {
+            std::cerr << "Erreur: Fichier binaire de produits invalide " << fichier << std::endl;
+            return false;
+        }
+
+        capaciteMax = entete.capacite;
+        produits.resize(entete.nbProduits);
+        std::memcpy(produits.data(), fichierMappe.debut() + sizeof(entete), entete.nbProduits * sizeof(Produit));
+        for (size_t i = 0; i < produits.size(); ++i) {
+            Produit& prod = produits[i];
+            if (!(prod.poids > 0) || !(prod.valeur > 0) || !std::isfinite(prod.poids) || !std::isfinite(prod.valeur)) {
+                std::cerr << "Erreur: Poids ou valeur invalide pour le produit ID " << prod.id << " (produit " << i + 1 << ")" << std::endl;
+                produits.clear();
+                return false;
+            }
+            prod.ratio = prod.valeur / prod.poids;
+        }
+        calculerOrdreRatio();
+        return true;
+    }
+
+    // La matrice est utilisée en place dans la projection, qui reste ouverte tant que la matrice existe
+    bool lireVillesBinaire(std::shared_ptr<FichierMappe> projection, const std::string& fichier) {
+        const FichierMappe& fichierMappe = *projection;
+        EnteteBinaireVilles entete;
+        if (fichierMappe.taille() < sizeof(entete)) {
+            std::cerr << "Erreur: En-tête binaire tronqué dans " << fichier << std::endl;
+            return false;
+        }
+        std::memcpy(&entete, fichierMappe.debut(), sizeof(entete));
+
+        if (entete.version != VERSION_FORMAT_BINAIRE) {
+            std::cerr << "Erreur: Version de format binaire non supportée (" << entete.version << ") dans " << fichier << std::endl;
+            return false;
+        }
+
+        const size_t tailleFichier = fichierMappe.taille();
+        if (entete.nbVilles == 0 || entete.nbVilles > static_cast<uint64_t>(std::numeric_limits<int>::max())
+            || entete.pas < entete.nbVilles || entete.decalageMatrice % ALIGNEMENT_BINAIRE != 0
+            || entete.decalageNoms > tailleFichier || entete.nbVilles >= (tailleFichier - entete.decalageNoms) / sizeof(uint64_t)
+            || entete.decalageMatrice > tailleFichier
+            || entete.pas > (tailleFichier - entete.decalageMatrice) / sizeof(double) / entete.nbVilles) {
+            std::cerr << "Erreur: Fichier binaire de villes invalide " << fichier << std::endl;
+            return false;
+        }
+
+        const size_t tailleTable = (entete.nbVilles + 1) * sizeof(uint64_t);
+        if (tailleFichier < entete.decalageNoms + tailleTable) {
+            std::cerr << "Erreur: Fichier binaire de villes invalide " << fichier << std::endl;
+            return false;
+        }
+
+        const int nbVilles = static_cast<int>(entete.nbVilles);
+        std::vector<uint64_t> decalages(entete.nbVilles + 1);
+        std::memcpy(decalages.data(), fichierMappe.debut() + entete.decalageNoms, tailleTable);
+        const char* noms = fichierMappe.debut() + entete.decalageNoms + tailleTable;
+        bool decalagesValides = entete.decalageNoms + tailleTable <= entete.decalageMatrice
+            && decalages.front() == 0 && decalages.back() <= entete.decalageMatrice - entete.decalageNoms - tailleTable;
+        for (size_t i = 0; decalagesValides && i < entete.nbVilles; ++i) decalagesValides = decalages[i] <= decalages[i + 1];
+        if (!decalagesValides) {
+            std::cerr << "Erreur: Fichier binaire de villes invalide " << fichier << std::endl;
+            return false;
+        }
+
+        villes.clear();
+        villes.reserve(nbVilles);
+        for (int i = 0; i < nbVilles; ++i) {
+            villes.push_back({ i, std::string(noms + decalages[i], decalages[i + 1] - decalages[i]) });
+        }
+
+        const double* matrice = reinterpret_cast<const double*>(fichierMappe.debut() + entete.decalageMatrice);
+        projection->conseillerAccesAleatoire();
+        matriceTriangulaire.liberer();
+        coordonnees.liberer();
+        matriceReduite = std::monostate();
+        matriceEnergie.projeter(std::move(projection), matrice, entete.nbVilles, entete.pas);
+        appliquerModeStockage();
+        calculerVoisins();
+        return true;
+    }
+
+    // Première erreur rencontrée dans la matrice : ligne -1 si aucune, colonne -1 pour une erreur de format
+    struct ErreurMatrice {
+        int ligne = -1;
+        int colonne = -1;
+    };
+
+    // En stockage triangulaire, le triangle inférieur est validé mais pas conservé
+    // (sa comparaison au triangle supérieur se fait ensuite, dans triangleInferieurSymetrique)
+    ErreurMatrice lireLigneMatrice(std::string_view texte, int i, int nbVilles) {
+        const char* p = texte.data();
+        const char* finLigne = p + texte.size();
+        const bool triangulaire = matriceTriangulaire.taille() > 0;
+        double* ligneMatrice = triangulaire ? nullptr : matriceEnergie.ligne(i);
+        double valeur;
+        for (int j = 0; j < nbVilles; ++j) {
+            if (!lireNombre(p, finLigne, valeur)) {
+                return { i, -1 };
+            }
+
+            if (valeur < 0) {
+                return { i, j };
+            }
+
+            if (!triangulaire) ligneMatrice[j] = valeur;
+            else if (j >= i) matriceTriangulaire.element(i, j) = valeur;
+        }
+        return {};
+    }
+
+    // Comparaison de la matrice dense avec sa transposée, par tuiles pour rester dans le cache
+    bool detecterSymetrie() const {
+        const VueMatrice E = energie();
+        const size_t n = E.taille();
+        constexpr size_t TUILE = 64;
+        const size_t nbTuiles = (n + TUILE - 1) / TUILE;
+        std::atomic<bool> symetrique{ true };
+        executerEnParallele(nbTuiles, nbThreadsChargement, [&](size_t ti) {
+            for (size_t tj = ti; tj < nbTuiles && symetrique.load(std::memory_order_relaxed); ++tj) {
+                for (size_t i = ti * TUILE; i < std::min(n, (ti + 1) * TUILE); ++i) {
+                    const double* ligne = E.ligne(static_cast<int>(i));
+                    for (size_t j = std::max(i + 1, tj * TUILE); j < std::min(n, (tj + 1) * TUILE); ++j) {
+                        if (ligne[j] != E(static_cast<int>(j), static_cast<int>(i))) {
+                            symetrique.store(false, std::memory_order_relaxed);
+                            return;
+                        }
+                    }
+                }
+            }
+            });
+        return symetrique.load();
+    }
+
+    // Après chargement : détection de la symétrie et passage éventuel au triangle supérieur
+    void appliquerModeStockage() {
+        if (matriceTriangulaire.taille() > 0) {
+            matriceSymetrique = true;
+            appliquerPrecision();
+            return;
+        }
+
+        matriceSymetrique = detecterSymetrie();
+        const bool versTriangulaire = modeStockage == ModeStockage::Triangulaire
+            || (modeStockage == ModeStockage::Auto && matriceSymetrique);
+        if (!versTriangulaire) {
+            appliquerPrecision();
+            return;
+        }
+
+        if (!matriceSymetrique) {
+            std::cerr << "Attention: matrice d'énergie non symétrique, seul le triangle supérieur est conservé" << std::endl;
+            matriceSymetrique = true;
+        }
+
+        const VueMatrice E = energie();
+        const size_t n = E.taille();
+        matriceTriangulaire.redimensionner(n);
+        for (size_t i = 0; i < n; ++i) {
+            const double* ligne = E.ligne(static_cast<int>(i));
+            for (size_t j = i; j < n; ++j) matriceTriangulaire.element(i, j) = ligne[j];
+        }
+        matriceEnergie.liberer();
+        appliquerPrecision();
+    }
+
+    // Le pas de quantification couvre [0, max] sur 65535 niveaux
+    double echelleQuantification() const {
+        double maximum = 0.0;
+        avecEnergie([&](const auto& E) {
+            const size_t n = E.taille();
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t j = 0; j < n; ++j) maximum = std::max(maximum, E(static_cast<int>(i), static_cast<int>(j)));
+            }
+            });
+        return maximum > 0.0 ? maximum / std::numeric_limits<uint16_t>::max() : 1.0;
+    }
+
+    template <typename T>
+    void convertirPrecision(double echelle) {
+        if (matriceTriangulaire.taille() > 0) {
+            const VueMatriceTriangulaire<double> S = matriceTriangulaire.vue();
+            MatriceTriangulaire<T> reduite;
+            reduite.echelle = echelle;
+            reduite.redimensionner(S.n);
+            for (size_t i = 0; i < S.n; ++i) {
+                for (size_t j = i; j < S.n; ++j) reduite.element(i, j) = encoderEnergie<T>(S(static_cast<int>(i), static_cast<int>(j)), echelle);
+            }
+            matriceTriangulaire.liberer();
+            matriceReduite = std::move(reduite);
+        }
+        else {
+            const VueMatrice S = energie();
+            MatriceDense<T> reduite;
+            reduite.echelle = echelle;
+            reduite.redimensionner(S.n);
+            executerEnParallele(S.n, nbThreadsChargement, [&](size_t i) {
+                const double* source = S.ligne(static_cast<int>(i));
+                T* destination = reduite.ligne(i);
+                for (size_t j = 0; j < S.n; ++j) destination[j] = encoderEnergie<T>(source[j], echelle);
+                });
+            matriceEnergie.liberer();
+            matriceReduite = std::move(reduite);
+        }
+    }
+
+    void appliquerPrecision() {
+        if (precision == Precision::Float) convertirPrecision<float>(1.0);
+        else if (precision == Precision::Quantifie16) convertirPrecision<uint16_t>(echelleQuantification());
+    }
+
+    // Chaque bloc garde sa première erreur ; on rapporte celle de plus petite ligne, comme une lecture séquentielle
+    ErreurMatrice lireMatriceParallele(const std::vector<std::string_view>& lignes, int nbVilles) {
+        const size_t nbLignes = lignes.size();
+        unsigned int nbThreads = nbThreadsChargement ? nbThreadsChargement : std::max(1u, std::thread::hardware_concurrency());
+        const size_t tailleBloc = std::max<size_t>(16, nbLignes / (static_cast<size_t>(nbThreads) * 8));
+        const size_t nbBlocs = (nbLignes + tailleBloc - 1) / tailleBloc;
+
+        std::vector<ErreurMatrice> erreursBlocs(nbBlocs);
+        executerEnParallele(nbBlocs, nbThreads, [&](size_t bloc) {
+            size_t fin = std::min(nbLignes, (bloc + 1) * tailleBloc);
+            for (size_t i = bloc * tailleBloc; i < fin; ++i) {
+                ErreurMatrice e = lireLigneMatrice(lignes[i], static_cast<int>(i), nbVilles);
+                if (e.ligne >= 0) {
+                    erreursBlocs[bloc] = e;
+                    return;
+                }
+            }
+            });
+
+        for (const auto& e : erreursBlocs) {
+            if (e.ligne >= 0) return e;
+        }
+        return {};
+    }
+
+    // Stockage triangulaire : relit le triangle inférieur des lignes déjà validées et le compare
+    // au triangle supérieur conservé (après lireMatriceParallele, qui a rempli ce dernier)
+    bool triangleInferieurSymetrique(const std::vector<std::string_view>& lignes) const {
+        unsigned int nbThreads = nbThreadsChargement ? nbThreadsChargement : std::max(1u, std::thread::hardware_concurrency());
+        std::atomic<bool> symetrique{ true };
+        executerEnParallele(lignes.size(), nbThreads, [&](size_t i) {
+            if (!symetrique.load(std::memory_order_relaxed)) return;
+            const char* p = lignes[i].data();
+            const char* finLigne = p + lignes[i].size();
+            double valeur;
+            for (size_t j = 0; j < i; ++j) {
+                lireNombre(p, finLigne, valeur);
+                if (valeur != matriceTriangulaire.element(j, i)) {
+                    symetrique.store(false, std::memory_order_relaxed);
+                    return;
+                }
+            }
+            });
+        return symetrique.load();
+    }
+};
+
+// Identifie le contenu d'un fichier sans le lire : date de modification (en nanosecondes, ou en
+// unités de 100 ns sous Windows, pour distinguer deux réécritures dans la même seconde) et taille
+struct SignatureFichier {
+    long long dateModification = -1;
+    long long taille = -1;
+
+    bool operator==(const SignatureFichier& autre) const {
+        return dateModification == autre.dateModification && taille == autre.taille;
+    }
+};
+
+inline SignatureFichier signatureFichier(const std::string& fichier) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA infos;
+    if (!GetFileAttributesExA(fichier.c_str(), GetFileExInfoStandard, &infos)) return {};
+    const long long date = (static_cast<long long>(infos.ftLastWriteTime.dwHighDateTime) << 32) | infos.ftLastWriteTime.dwLowDateTime;
+    const long long taille = (static_cast<long long>(infos.nFileSizeHigh) << 32) | infos.nFileSizeLow;
+    return { date, taille };
+#else
+    struct stat infos;
+    if (stat(fichier.c_str(), &infos) != 0) return {};
+#if defined(__APPLE__)
+    const struct timespec& date = infos.st_mtimespec;
+#else
+    const struct timespec& date = infos.st_mtim;
+#endif
+    return { static_cast<long long>(date.tv_sec) * 1000000000LL + date.tv_nsec, static_cast<long long>(infos.st_size) };
+#endif
+}
+
+// Instances chargées une seule fois par processus et partagées en lecture seule entre les réplications.
+// Une entrée est rechargée si la date de modification ou la taille d'un des fichiers change.
+class CacheInstances {
+public:
+    static CacheInstances& global() {
+        static CacheInstances cache;
+        return cache;
+    }
+
+    // Renvoie nullptr si la lecture échoue (l'erreur est affichée par GestionDonnees)
+    std::shared_ptr<const GestionDonnees> obtenir(const std::string& fichierProduits, const std::string& fichierVilles,
+        ModeStockage modeStockage = ModeStockage::Dense, Precision precision = Precision::Double) {
+        const Cle cle{ fichierProduits, fichierVilles, static_cast<int>(modeStockage), static_cast<int>(precision) };
+        const SignatureFichier signatureProduits = signatureFichier(fichierProduits);
+        const SignatureFichier signatureVilles = signatureFichier(fichierVilles);
+
+        std::promise<std::shared_ptr<const GestionDonnees>> promesse;
+        std::shared_future<std::shared_ptr<const GestionDonnees>> instance;
+        bool dejaPresente = false;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto it = entrees.find(cle);
+            if (it != entrees.end() && it->second.signatureProduits == signatureProduits && it->second.signatureVilles == signatureVilles) {
+                instance = it->second.instance;
+                dejaPresente = true;
+            }
+            else {
+                instance = promesse.get_future().share();
+                entrees[cle] = { signatureProduits, signatureVilles, instance };
+            }
+        }
+        if (dejaPresente) return instance.get();
+
+        // Chargement hors verrou : les autres réplications qui demandent la même instance attendent le futur
+        auto donnees = std::make_shared<GestionDonnees>();
+        donnees->modeStockage = modeStockage;
+        donnees->precision = precision;
+        if (!donnees->lireProduits(fichierProduits) || !donnees->lireVilles(fichierVilles)) {
+            donnees.reset();
+        }
+        promesse.set_value(donnees);
+
+        if (!donnees) {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto it = entrees.find(cle);
+            if (it != entrees.end() && it->second.instance.valid()
+                && it->second.instance.wait_for(std::chrono::seconds(0)) == std::future_status::ready
+                && it->second.instance.get() == nullptr) {
+                entrees.erase(it);
+            }
+        }
+        return donnees;
+    }
+
+    void vider() {
+        std::lock_guard<std::mutex> lock(mtx);
+        entrees.clear();
+    }
+
+private:
+    using Cle = std::tuple<std::string, std::string, int, int>;
+
+    struct Entree {
+        SignatureFichier signatureProduits;
+        SignatureFichier signatureVilles;
+        std::shared_future<std::shared_ptr<const GestionDonnees>> instance;
+    };
+
+    std::mutex mtx;
+    std::map<Cle, Entree> entrees;
+};
+
+// Résultat d'une réplication, tel qu'écrit dans resultats.txt (CSV) ou resultats.bin
+struct EnregistrementResultat {
+    uint32_t graine;
+    uint32_t reserve;
+    double benefice;
+    double energie;
+    double score;
+    double borne; // borne inférieure de l'énergie (0 si non calculée)
+    double ecart; // (energie - borne) / energie
+};
+
+enum class FormatResultats {
+    Csv,     // graine,benefice,energie,score,borne,ecart
+    Binaire  // en-tête "TP6R" + version, puis des EnregistrementResultat bruts
+};
+
+constexpr char MAGIQUE_RESULTATS[4] = { 'T', 'P', '6', 'R' };
+constexpr uint32_t VERSION_FORMAT_RESULTATS = 2; // 2 : colonnes borne et ecart
+
+inline const char* fichierResultats(FormatResultats format) {
+    return format == FormatResultats::Binaire ? "resultats.bin" : "resultats.txt";
+}
+
+// Écrit "graine,benefice,energie,score,borne,ecart\n" avec std::to_chars ; renvoie la fin du texte
+// Taille de tampon suffisante pour une ligne : l'uint32 (10 caractères), cinq doubles au plus court
+// aller-retour (24 caractères au plus chacun) et six séparateurs
+constexpr size_t TAILLE_LIGNE_CSV = 192;
+
+// Renvoie la fin de la ligne écrite dans [p, fin), ou p si le tampon est trop court (rien n'est écrit)
+inline char* formaterResultatCsv(const EnregistrementResultat& r, char* p, char* fin) {
+    char* const debut = p;
+    bool complet = true;
+    auto ecrire = [&](auto valeur, char separateur) {
+        if (!complet) return;
+        const auto res = std::to_chars(p, fin, valeur);
+        if (res.ec != std::errc() || res.ptr == fin) {
+            complet = false;
+            return;
+        }
+        p = res.ptr;
+        *p++ = separateur;
+    };
+    ecrire(r.graine, ',');
+    ecrire(r.benefice, ',');
+    ecrire(r.energie, ',');
+    ecrire(r.score, ',');
+    ecrire(r.borne, ',');
+    ecrire(r.ecart, '\n');
+    return complet ? p : debut;
+}
+
+// File bornée multi-producteurs sans verrou (tableau circulaire avec numéros de séquence)
+template <typename T>
+class FileSansVerrou {
+public:
+    explicit FileSansVerrou(size_t capacite) : cases(capacite), masque(capacite - 1) {
+        assert(capacite >= 2 && (capacite & (capacite - 1)) == 0);
+        for (size_t i = 0; i < capacite; ++i) cases[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // Renvoie false si la file est pleine
+    bool deposer(const T& valeur) {
+        size_t position = finFile.load(std::memory_order_relaxed);
+        for (;;) {
+            Case& c = cases[position & masque];
+            const size_t sequence = c.sequence.load(std::memory_order_acquire);
+            const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0) {
+                if (finFile.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    c.valeur = valeur;
+                    c.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0) {
+                return false;
+            }
+            else {
+                position = finFile.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Renvoie false si la file est vide
+    bool retirer(T& valeur) {
+        size_t position = debutFile.load(std::memory_order_relaxed);
+        for (;;) {
+            Case& c = cases[position & masque];
+            const size_t sequence = c.sequence.load(std::memory_order_acquire);
+            const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            if (difference == 0) {
+                if (debutFile.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    valeur = c.valeur;
+                    c.sequence.store(position + masque + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0) {
+                return false;
+            }
+            else {
+                position = debutFile.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Case {
+        std::atomic<size_t> sequence;
+        T valeur;
+    };
+
+    std::vector<Case> cases;
+    const size_t masque;
+    alignas(64) std::atomic<size_t> finFile{ 0 };
+    alignas(64) std::atomic<size_t> debutFile{ 0 };
+};
+
+// Reçoit les résultats des réplications sans verrou ; un thread d'écriture les formate
+// et les écrit par blocs (le fichier est ouvert en ajout, une seule fois)
+class PuitsResultats {
+public:
+    PuitsResultats(const std::string& fichier, FormatResultats format = FormatResultats::Csv)
+        : format(format), file(CAPACITE_FILE) {
+        const bool nouveauFichier = signatureFichier(fichier).taille <= 0;
+        sortie.open(fichier, std::ios::app | std::ios::binary);
+        if (!sortie) {
+            std::cerr << "Erreur: Impossible d'ouvrir le fichier " << fichier << std::endl;
+            echec = true;
+        }
+        tampon.reserve(TAILLE_BLOC + 256);
+        if (format == FormatResultats::Binaire && nouveauFichier) {
+            tampon.append(MAGIQUE_RESULTATS, 4);
+            const uint32_t version = VERSION_FORMAT_RESULTATS;
+            tampon.append(reinterpret_cast<const char*>(&version), sizeof(version));
+        }
+        ecrivain = std::thread([this]() { boucleEcriture(); });
+    }
+
+    PuitsResultats(const PuitsResultats&) = delete;
+    PuitsResultats& operator=(const PuitsResultats&) = delete;
+
+    ~PuitsResultats() { terminer(); }
+
+    // false si le fichier de résultats n'a pas pu être ouvert
+    bool ouvert() const { return sortie.is_open(); }
+
+    void ajouter(const EnregistrementResultat& resultat) {
+        while (!file.deposer(resultat)) std::this_thread::yield();
+    }
+
+    // Écrit les enregistrements restants et arrête l'écrivain ; false si des résultats ont été perdus
+    bool terminer() {
+        if (ecrivain.joinable()) {
+            arret.store(true, std::memory_order_release);
+            ecrivain.join();
+        }
+        return !echec;
+    }
+
+private:
+    static constexpr size_t CAPACITE_FILE = 1 << 14;
+    static constexpr size_t TAILLE_BLOC = 1 << 20;
+
+    void boucleEcriture() {
+        EnregistrementResultat r;
+        char ligne[TAILLE_LIGNE_CSV];
+        for (;;) {
+            const bool dernierPassage = arret.load(std::memory_order_acquire);
+            bool recu = false;
+            while (file.retirer(r)) {
+                recu = true;
+                if (format == FormatResultats::Csv) {
+                    tampon.append(ligne, formaterResultatCsv(r, ligne, ligne + sizeof(ligne)));
+                }
+                else {
+                    tampon.append(reinterpret_cast<const char*>(&r), sizeof(r));
+                }
+                if (tampon.size() >= TAILLE_BLOC) vider();
+            }
+            if (dernierPassage) break;
+            if (!recu) std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        vider();
+        sortie.flush();
+        if (!sortie) echec = true;
+    }
+
+    void vider() {
+        sortie.write(tampon.data(), tampon.size());
+        if (!sortie) echec = true;
+        tampon.clear();
+    }
+
+    const FormatResultats format;
+    FileSansVerrou<EnregistrementResultat> file;
+    std::ofstream sortie;
+    std::string tampon;
+    std::atomic<bool> arret{ false };
+    bool echec = false; // écrit par l'écrivain, lu après join dans terminer
+    std::thread ecrivain;
+};
+
+// Meilleures solutions vues par un thread de réplication ; fusionnées une seule fois à la fin
+struct alignas(64) MeilleuresSolutions {
+    std::vector<Produit> solutionP1;
+    std::vector<int> solutionP2;
+    double scoreP1 = -std::numeric_limits<double>::infinity();
+    double scoreP2 = -std::numeric_limits<double>::infinity();
+};
+
+// Maximum atomique : renvoie true si valeur a remplacé le maximum courant
+inline bool majMaximumAtomique(std::atomic<double>& maximum, double valeur) {
+    double courant = maximum.load(std::memory_order_relaxed);
+    while (valeur > courant) {
+        if (maximum.compare_exchange_weak(courant, valeur, std::memory_order_relaxed)) return true;
+    }
+    return false;
+}
+
+enum class SolveurSac {
+    Glouton,        // resoudreSacADosRandomise
+    Exact,          // resoudreSacADosExact (programmation dynamique sur poids entiers)
+    BranchAndBound, // resoudreSacADosBranchAndBound (poids réels, borne de Dantzig)
+    Noyau           // resoudreSacADosNoyau (grandes instances : seul un noyau autour de l'objet critique est exploré)
+};
+
+// Liste restreinte de candidats (GRASP) des constructions gloutonnes randomisées
+enum class ListeRestreinte {
+    Blocs,       // historique : un candidat tiré dans chaque bloc de tailleListe produits, ou parmi les tailleListe villes les plus proches
+    Cardinalite, // les tailleListe meilleurs candidats encore possibles
+    Valeur       // les candidats dont l'évaluation est à moins de alpha * (pire - meilleur) du meilleur
+};
+
+// GRASP réactif (Prais et Ribeiro) : alpha est tiré parmi VALEURS avec des probabilités
+// proportionnelles à (moyenne obtenue avec alpha / meilleure solution)^AMPLIFICATION,
+// recalculées toutes les PERIODE constructions
+class AlphaReactif {
+public:
+    static constexpr std::array<double, 6> VALEURS = { 0.0, 0.1, 0.2, 0.3, 0.5, 0.8 };
+    static constexpr int PERIODE = 10;
+    static constexpr double AMPLIFICATION = 10.0;
+
+    explicit AlphaReactif(bool maximiser) : maximiser(maximiser) {
+        probabilites.fill(1.0 / VALEURS.size());
+    }
+
+    size_t tirer(std::mt19937& gen) const {
+        std::discrete_distribution<size_t> dist(probabilites.begin(), probabilites.end());
+        return dist(gen);
+    }
+
+    void enregistrer(size_t k, double valeur) {
+        sommes[k] += valeur;
+        ++nombres[k];
+        if (++constructions == 1 || (maximiser ? valeur > meilleure : valeur < meilleure)) meilleure = valeur;
+        if (constructions % PERIODE == 0) recalculer();
+    }
+
+private:
+    void recalculer() {
+        std::array<double, VALEURS.size()> q{};
+        double total = 0.0;
+        for (size_t k = 0; k < VALEURS.size(); ++k) {
+            if (nombres[k] == 0 || meilleure <= 0.0) {
+                q[k] = 1.0; // alpha jamais essayé : on lui laisse sa chance
+            }
+            else {
+                const double moyenne = sommes[k] / nombres[k];
+                q[k] = std::pow(maximiser ? moyenne / meilleure : meilleure / std::max(moyenne, meilleure), AMPLIFICATION);
+            }
+            total += q[k];
+        }
+        for (size_t k = 0; k < VALEURS.size(); ++k) probabilites[k] = q[k] / total;
+    }
+
+    const bool maximiser;
+    std::array<double, VALEURS.size()> probabilites{};
+    std::array<double, VALEURS.size()> sommes{};
+    std::array<int, VALEURS.size()> nombres{};
+    double meilleure = 0.0;
+    int constructions = 0;
+};
+
+// Choix des algorithmes, recopiés dans chaque réplication
+struct ParametresResolution {
+    SolveurSac solveurSac = SolveurSac::Glouton;
+    double echelleSac = 1.0;              // poids entiers = ceil(poids * echelleSac) pour le solveur exact
+    long long limiteNoeudsSac = 10000000; // limites du branch and bound
+    double limiteTempsSac = 1.0;          // en secondes
+    bool rechercheLocaleSac = true;       // ameliorerSacADos après le solveur
+    ListeRestreinte listeRestreinte = ListeRestreinte::Blocs;
+    int tailleListe = 2;                  // N de resoudreSacADosRandomise et M de resoudreTourneeRandomisee
+    double alpha = 0.2;                   // liste restreinte par valeur
+    bool alphaReactif = false;
+    int iterationsGrasp = 1;              // constructions par réplication, la meilleure est gardée
+    bool rechercheLocaleTournee = true;   // ameliorerTournee après chaque construction
+    double tempsLK = 0.0;                 // > 0 : Lin-Kernighan itéré sur la meilleure tournée (secondes)
+    int villesMaxHeldKarp = 0;            // tournée exacte jusqu'à ce nombre de villes (au plus VILLES_MAX_HELD_KARP ; 0 : jamais)
+    size_t memoireMaxHeldKarp = size_t(1) << 30; // octets de table au-delà desquels Held-Karp cède à l'heuristique
+    int iterationsBorne = 0;              // sous-gradient de borneInferieureTournee (0 : pas de borne)
+    double ecartArret = 0.0;              // replicate : arrêt dès qu'une tournée est à moins de cet écart de la borne
+};
+
+// Issue d'un solveur exact de P1 : si une limite a été atteinte, borneSuperieure reste
+// une borne prouvée et ecart = (borneSuperieure - valeur) / borneSuperieure
+struct ResultatSacExact {
+    std::vector<int> indices;
+    double valeur = 0.0;
+    double borneSuperieure = 0.0;
+    double ecart = 0.0;
+    bool optimal = true;
+    long long noeuds = 0;
+};
+
+// Villes non visitées d'une construction de tournée, en tableau dense : retrait en O(1) par échange
+// avec la dernière, et les parcours ne touchent que les villes restantes
+class VillesRestantes {
+public:
+    explicit VillesRestantes(int n) : villes(n), positions(n), nb(n) {
+        for (int v = 0; v < n; ++v) villes[v] = positions[v] = v;
+    }
+
+    bool contient(int v) const { return positions[v] < nb; }
+    int taille() const { return nb; }
+    const int* donnees() const { return villes.data(); }
+    int ville(int k) const { return villes[k]; }
+
+    void retirer(int v) {
+        const int p = positions[v];
+        const int derniere = villes[nb - 1];
+        villes[p] = derniere;
+        positions[derniere] = p;
+        villes[nb - 1] = v;
+        positions[v] = nb - 1;
+        --nb;
+    }
+
+private:
+    std::vector<int> villes;
+    std::vector<int> positions;
+    int nb;
+};
+
+// Tournée en tableau avec la position de chaque ville, pour les recherches locales. Le tableau
+// est modifié en place ; recommencerEn0 le remet dans la convention des tournées (ville 0 en tête).
+class TourneeTableau {
+public:
+    explicit TourneeTableau(std::vector<int>& tournee)
+        : villes(tournee), n(static_cast<int>(tournee.size())), positions(tournee.size()) {
+        for (int i = 0; i < n; ++i) positions[villes[i]] = i;
+    }
+
+    int taille() const { return n; }
+    int ville(int i) const { return villes[i]; }
+    int position(int v) const { return positions[v]; }
+    int suivante(int v) const { return villes[positions[v] + 1 == n ? 0 : positions[v] + 1]; }
+    int precedente(int v) const { return villes[positions[v] == 0 ? n - 1 : positions[v] - 1]; }
+
+    // Inverse le chemin de la position i à la position j (sens de parcours, circulaire). Si ce
+    // chemin dépasse la moitié de la tournée, c'est le complément qui est inversé (même tournée
+    // parcourue dans l'autre sens) ; appeler deux fois inverser(i, j) rend la tournée de départ.
+    void inverser(int i, int j) {
+        int longueur = (j - i + n) % n + 1;
+        if (2 * longueur > n) {
+            const int debut = (j + 1) % n;
+            j = (i - 1 + n) % n;
+            i = debut;
+            longueur = n - longueur;
+        }
+        for (int k = 0; k < longueur / 2; ++k) {
+            std::swap(villes[i], villes[j]);
+            positions[villes[i]] = i;
+            positions[villes[j]] = j;
+            i = (i + 1 == n) ? 0 : i + 1;
+            j = (j == 0) ? n - 1 : j - 1;
+        }
+    }
+
+    // Rotation à gauche de decalage cases de l'arc circulaire [debut, debut + longueur)
+    void tournerArc(int debut, int longueur, int decalage) {
+        arc.resize(longueur);
+        for (int k = 0; k < longueur; ++k) arc[k] = villes[(debut + k) % n];
+        std::rotate(arc.begin(), arc.begin() + decalage, arc.end());
+        for (int k = 0; k < longueur; ++k) {
+            const int i = (debut + k) % n;
+            villes[i] = arc[k];
+            positions[arc[k]] = i;
+        }
+    }
+
+    void recommencerEn0() {
+        if (n == 0) return;
+        std::rotate(villes.begin(), villes.begin() + positions[0], villes.end());
+        for (int i = 0; i < n; ++i) positions[villes[i]] = i;
+    }
+
+    void affecter(const std::vector<int>& autre) {
+        villes = autre;
+        for (int i = 0; i < n; ++i) positions[villes[i]] = i;
+    }
+
+private:
+    std::vector<int>& villes;
+    const int n;
+    std::vector<int> positions;
+    std::vector<int> arc;
+};
+
+// Bits "don't look" des recherches locales : file des villes à réexaminer, sans doublon
+class FileVillesActives {
+public:
+    explicit FileVillesActives(const std::vector<int>& villes) : dansFile(villes.size(), 1), file(villes) {}
+
+    void activer(int v) {
+        if (dansFile[v]) return;
+        dansFile[v] = 1;
+        file.push_back(v);
+    }
+
+    bool extraire(int& v) {
+        if (tete == file.size()) {
+            file.clear();
+            tete = 0;
+            return false;
+        }
+        v = file[tete++];
+        dansFile[v] = 0;
+        return true;
+    }
+
+private:
+    std::vector<char> dansFile;
+    std::vector<int> file;
+    size_t tete = 0;
+};
+
+// Double pont local : les blocs consécutifs B et C (au plus 50 villes chacun) sont échangés,
+// A B C D -> A C B D. Aucun segment n'est retourné, le delta est donc exact sur matrice
+// asymétrique. Renvoie la variation d'énergie ; extremites reçoit les villes touchées.
+template <typename Energie>
+double perturberDoublePont(const Energie& E, TourneeTableau& T, std::mt19937& gen, std::vector<int>* extremites) {
+    const int n = T.taille();
+    const int longueurMax = std::max(1, std::min(50, (n - 2) / 3));
+    std::uniform_int_distribution<int> distPosition(0, n - 1), distLongueur(1, longueurMax);
+    const int p = distPosition(gen);
+    const int lb = distLongueur(gen), lc = distLongueur(gen);
+    const int a = T.ville(p), b1 = T.ville((p + 1) % n), b2 = T.ville((p + lb) % n);
+    const int c1 = T.ville((p + lb + 1) % n), c2 = T.ville((p + lb + lc) % n), d = T.ville((p + lb + lc + 1) % n);
+    const double delta = E(a, c1) + E(c2, b1) + E(b2, d) - E(a, b1) - E(b2, c1) - E(c2, d);
+    T.tournerArc((p + 1) % n, lb + lc, lb);
+    if (extremites) *extremites = { a, b1, b2, c1, c2, d };
+    return delta;
+}
+
+// Lin-Kernighan (matrice symétrique) à mouvements 2-opt enchaînés : depuis t1 et t2 = suivante(t1),
+// on ajoute (t2, t3) pour t3 voisin de t2, retire (t3, t4) et referme par (t4, t1) en inversant
+// t2 .. t4 ; t4 devient le nouveau t2 tant que le gain partiel reste positif, jusqu'à PROFONDEUR
+// niveaux. La chaîne est coupée au meilleur gain de fermeture, les inversions au-delà sont
+// annulées. Les LARGEUR meilleurs t3 sont essayés au premier niveau, un seul ensuite. La boucle
+// itérée perturbe par double pont et garde la meilleure tournée.
+template <typename Energie>
+class OptimiseurLK {
+public:
+    static constexpr int PROFONDEUR = 6;
+    static constexpr int LARGEUR = 3;
+
+    OptimiseurLK(const Energie& E, const ListesVoisins& listes, std::vector<int>& tournee)
+        : E(E), listes(listes), villes(tournee), T(tournee), file(tournee) {}
+
+    // Optimum local puis perturbations jusqu'à ce que arreter() ; renvoie le gain total
+    template <typename Arret>
+    double optimiser(std::mt19937& gen, Arret&& arreter) {
+        double gainTotal = ameliorer();
+        std::vector<int> meilleure = villes;
+        std::vector<int> extremites;
+        while (!arreter()) {
+            double ecart = perturberDoublePont(E, T, gen, &extremites);
+            for (int v : extremites) file.activer(v);
+            ecart -= ameliorer();
+            if (ecart < -1e-9) {
+                gainTotal -= ecart;
+                meilleure = villes;
+            }
+            else {
+                T.affecter(meilleure);
+            }
+        }
+        return gainTotal;
+    }
+
+    // Vide la file des villes actives ; renvoie le gain
+    double ameliorer() {
+        double gain = 0.0;
+        for (int t1; file.extraire(t1); ) {
+            for (int sens = 0; sens < 2; ++sens) {
+                const double g = etape(t1, sens);
+                if (g > 0.0) {
+                    gain += g;
+                    file.activer(t1);
+                    break;
+                }
+            }
+        }
+        return gain;
+    }
+
+private:
+    struct Candidat {
+        int t3, t4;
+        double gainPartiel;
+    };
+
+    int suivante(int v, int sens) const { return sens == 0 ? T.suivante(v) : T.precedente(v); }
+    int precedente(int v, int sens) const { return sens == 0 ? T.precedente(v) : T.suivante(v); }
+
+    // Candidats t3 de t2 pour le gain partiel G, par gain partiel décroissant
+    void candidats(int t1, int t2, int sens, double G, std::vector<Candidat>& liste) const {
+        liste.clear();
+        const int* voisins = listes.de(t2);
+        for (int r = 0; r < listes.k; ++r) {
+            const int t3 = voisins[r];
+            const double g1 = G - E(t2, t3);
+            if (g1 <= 1e-9) break;
+            if (t3 == t1 || t3 == suivante(t2, sens)) continue;
+            const int t4 = precedente(t3, sens);
+            liste.push_back({ t3, t4, g1 + E(t3, t4) });
+        }
+        std::sort(liste.begin(), liste.end(), [](const Candidat& x, const Candidat& y) { return x.gainPartiel > y.gainPartiel; });
+    }
+
+    // Inverse t2 .. t4 dans le sens de parcours : t1 -> t4 et t2 -> t3 deviennent consécutives
+    void appliquer(int t2, int t4, int sens) {
+        const int i = sens == 0 ? T.position(t2) : T.position(t4);
+        const int j = sens == 0 ? T.position(t4) : T.position(t2);
+        T.inverser(i, j);
+        inversions.emplace_back(i, j);
+    }
+
+    double etape(int t1, int sens) {
+        const int t2Initial = suivante(t1, sens);
+        candidats(t1, t2Initial, sens, E(t1, t2Initial), premiers);
+        for (size_t l = 0; l < premiers.size() && static_cast<int>(l) < LARGEUR; ++l) {
+            inversions.clear();
+            touchees.assign({ t1, t2Initial });
+            double meilleurGain = 0.0;
+            size_t meilleurNombre = 0;
+            int t2 = t2Initial;
+            int sensChaine = sens;
+            Candidat c = premiers[l];
+            for (int niveau = 0; niveau < PROFONDEUR; ++niveau) {
+                appliquer(t2, c.t4, sensChaine);
+                // Si c'est le complément qui a été inversé, la tournée se parcourt dans l'autre sens
+                if (suivante(t1, sensChaine) != c.t4) sensChaine ^= 1;
+                touchees.push_back(c.t3);
+                touchees.push_back(c.t4);
+                const double gainFermeture = c.gainPartiel - E(c.t4, t1);
+                if (gainFermeture > meilleurGain + 1e-9) {
+                    meilleurGain = gainFermeture;
+                    meilleurNombre = inversions.size();
+                }
+                t2 = c.t4;
+                candidats(t1, t2, sensChaine, c.gainPartiel, suivants);
+                if (suivants.empty()) break;
+                c = suivants.front();
+            }
+
+            while (inversions.size() > meilleurNombre) {
+                T.inverser(inversions.back().first, inversions.back().second);
+                inversions.pop_back();
+            }
+            if (meilleurNombre > 0) {
+                for (int v : touchees) file.activer(v);
+                return meilleurGain;
+            }
+        }
+        return 0.0;
+    }
+
+    const Energie& E;
+    const ListesVoisins& listes;
+    std::vector<int>& villes;
+    TourneeTableau T;
+    FileVillesActives file;
+    std::vector<Candidat> premiers, suivants;
+    std::vector<std::pair<int, int>> inversions;
+    std::vector<int> touchees;
+};
+
+// Au-delà, la table de Held-Karp (2^(n-1) * (n-1) cases) ne tient plus en mémoire
+constexpr int VILLES_MAX_HELD_KARP = 25;
+
+// Octets des tables de Held-Karp pour n villes : un coût et un prédécesseur par case
+inline size_t memoireHeldKarp(int n) {
+    if (n <= 1) return 0;
+    return (size_t(1) << (n - 1)) * static_cast<size_t>(n - 1) * (sizeof(double) + sizeof(uint8_t));
+}
+
+class AlgorithmesGloutonsRandomises {
+private:
+    const GestionDonnees& donnees;
+    std::mt19937 gen;
+    std::mutex mtx;
+
+    // Variables pour stocker les meilleures solutions
+    std::vector<Produit> meilleureSolutionP1;
+    std::vector<int> meilleureSolutionP2;
+    double meilleurScoreP1 = -std::numeric_limits<double>::infinity();
+    double meilleurScoreP2 = -std::numeric_limits<double>::infinity();
+
+    // Meilleurs scores tous threads confondus : une réplication qui ne les bat pas ne copie rien
+    std::atomic<double> scoreGlobalP1{ -std::numeric_limits<double>::infinity() };
+    std::atomic<double> scoreGlobalP2{ -std::numeric_limits<double>::infinity() };
+
+public:
+    ParametresResolution parametres;
+    ResultatSacExact dernierSacExact; // renseigné par les solveurs exacts appelés via resoudreSacADos()
+    double borneTournee = 0.0;        // borne inférieure de P2 recopiée dans les résultats (calculerBorneTournee)
+
+    AlgorithmesGloutonsRandomises(const GestionDonnees& d, unsigned int graine) : donnees(d), gen(graine) {}
+
+    // Problème P1 avec le solveur choisi dans parametres, suivi de la recherche locale
+    std::vector<Produit> resoudreSacADos() {
+        std::vector<int> indices;
+        if (parametres.solveurSac == SolveurSac::Exact) {
+            indices = resoudreSacADosExactIndices(parametres.echelleSac);
+        }
+        else if (parametres.solveurSac == SolveurSac::BranchAndBound) {
+            dernierSacExact = resoudreSacADosBranchAndBound(parametres.limiteNoeudsSac, parametres.limiteTempsSac);
+            indices = dernierSacExact.indices;
+        }
+        else if (parametres.solveurSac == SolveurSac::Noyau) {
+            dernierSacExact = resoudreSacADosNoyau(parametres.limiteNoeudsSac, parametres.limiteTempsSac);
+            indices = dernierSacExact.indices;
+        }
+        else {
+            return produitsSelectionnes(resoudreSacADosGrasp());
+        }
+
+        if (parametres.rechercheLocaleSac) ameliorerSacADos(indices);
+        return produitsSelectionnes(indices);
+    }
+
+    // GRASP sur P1 : iterationsGrasp constructions randomisées, chacune suivie de la recherche
+    // locale, et la meilleure est gardée
+    std::vector<int> resoudreSacADosGrasp() {
+        const ParametresResolution& p = parametres;
+        AlphaReactif reactif(true);
+        std::vector<int> meilleure;
+        double meilleureValeur = -1.0;
+        for (int iteration = 0; iteration < std::max(1, p.iterationsGrasp); ++iteration) {
+            const size_t k = p.alphaReactif ? reactif.tirer(gen) : 0;
+            const double alpha = p.alphaReactif ? AlphaReactif::VALEURS[k] : p.alpha;
+            std::vector<int> indices = (p.listeRestreinte == ListeRestreinte::Blocs)
+                ? resoudreSacADosRandomiseIndices(p.tailleListe)
+                : construireSacGrasp(p.listeRestreinte, p.tailleListe, alpha);
+            if (p.rechercheLocaleSac) ameliorerSacADos(indices);
+
+            double valeur = 0.0;
+            for (int i : indices) valeur += donnees.produits[i].valeur;
+            if (p.alphaReactif) reactif.enregistrer(k, valeur);
+            if (valeur > meilleureValeur) {
+                meilleureValeur = valeur;
+                meilleure = std::move(indices);
+            }
+        }
+        return meilleure;
+    }
+
+    // Construction GRASP de P1 sur l'ordre par ratio. Les produits encore candidats forment une liste
+    // doublement chaînée sur les rangs de cet ordre ; la capacité libre ne fait que diminuer, un produit
+    // qui ne tient plus est donc retiré définitivement dès qu'il est rencontré. Chaque étape ne parcourt
+    // que la liste restreinte, jamais l'ensemble des produits, et rien n'est trié.
+    std::vector<int> construireSacGrasp(ListeRestreinte mode, int taille, double alpha) {
+        std::vector<int> ordreLocal;
+        const std::vector<int>& ordre = ordreParRatio(ordreLocal);
+        const std::vector<Produit>& produits = donnees.produits;
+        const int n = static_cast<int>(ordre.size());
+        const int FIN = -1;
+
+        std::vector<int> suivant(n), precedent(n);
+        for (int r = 0; r < n; ++r) {
+            suivant[r] = (r + 1 < n) ? r + 1 : FIN;
+            precedent[r] = r - 1;
+        }
+        int tete = (n > 0) ? 0 : FIN;
+        int queue = n - 1;
+        auto retirer = [&](int r) {
+            if (precedent[r] != FIN) suivant[precedent[r]] = suivant[r]; else tete = suivant[r];
+            if (suivant[r] != FIN) precedent[suivant[r]] = precedent[r]; else queue = precedent[r];
+        };
+        auto poids = [&](int r) { return produits[ordre[r]].poids; };
+        auto ratio = [&](int r) { return produits[ordre[r]].ratio; };
+
+        std::vector<int> solution;
+        std::vector<int> liste;
+        double libre = donnees.capaciteMax;
+        while (tete != FIN) {
+            liste.clear();
+            if (mode == ListeRestreinte::Valeur) {
+                while (tete != FIN && poids(tete) > libre) retirer(tete);
+                while (queue != FIN && poids(queue) > libre) retirer(queue);
+                if (tete == FIN) break;
+                const double seuil = ratio(tete) - alpha * (ratio(tete) - ratio(queue));
+                for (int r = tete; r != FIN && ratio(r) >= seuil; ) {
+                    const int s = suivant[r];
+                    if (poids(r) > libre) retirer(r); else liste.push_back(r);
+                    r = s;
+                }
+            }
+            else {
+                for (int r = tete; r != FIN && static_cast<int>(liste.size()) < taille; ) {
+                    const int s = suivant[r];
+                    if (poids(r) > libre) retirer(r); else liste.push_back(r);
+                    r = s;
+                }
+            }
+            if (liste.empty()) break;
+
+            const int choisi = liste[std::uniform_int_distribution<size_t>(0, liste.size() - 1)(gen)];
+            solution.push_back(ordre[choisi]);
+            libre -= poids(choisi);
+            retirer(choisi);
+        }
+        return solution;
+    }
+
+    // Recherche locale en meilleure amélioration sur une solution réalisable : ajout d'un produit,
+    // échange 1-1 (un produit sorti, un entré) et échange 2-1 (deux sortis, un entré). Le poids et
+    // la valeur totaux sont tenus à jour, chaque mouvement s'évalue donc en O(1). Les échanges ne
+    // considèrent que les LARGEUR_VOISINAGE produits du sac de plus faible ratio et les
+    // LARGEUR_VOISINAGE produits hors du sac de plus fort ratio ; ces deux frontières sont tenues à
+    // jour d'un mouvement à l'autre (produits du sac triés par ratio, curseur sur le premier produit
+    // hors du sac dans l'ordre par ratio). L'ajout prend le produit hors du sac de plus forte valeur
+    // qui tient encore : un arbre sur des blocs de produits garde le poids minimal et la valeur
+    // maximale hors du sac de chaque sous-arbre, la recherche n'ouvre que les sous-arbres qui
+    // contiennent un produit assez léger et assez précieux. Renvoie le gain de valeur.
+    double ameliorerSacADos(std::vector<int>& indices, int maxMouvements = 100000) {
+        constexpr size_t LARGEUR_VOISINAGE = 32;
+        const std::vector<Produit>& produits = donnees.produits;
+        const int n = static_cast<int>(produits.size());
+        const double capacite = donnees.capaciteMax;
+        std::vector<int> ordreLocal;
+        const std::vector<int>& ordre = ordreParRatio(ordreLocal);
+        auto avantParRatio = [&](int a, int b) {
+            return produits[a].ratio > produits[b].ratio || (produits[a].ratio == produits[b].ratio && a < b);
+        };
+
+        std::vector<char> dansSac(n, 0);
+        double poidsTotal = 0.0, valeurTotale = 0.0;
+        for (int i : indices) {
+            dansSac[i] = 1;
+            poidsTotal += produits[i].poids;
+            valeurTotale += produits[i].valeur;
+        }
+        const double valeurInitiale = valeurTotale;
+
+        // Produits du sac dans l'ordre par ratio : les derniers sont les candidats à la sortie
+        std::vector<int> dedansTries(indices);
+        std::sort(dedansTries.begin(), dedansTries.end(), avantParRatio);
+        // Rang (dans l'ordre par ratio) à partir duquel chercher les candidats à l'entrée
+        size_t premierDehors = 0;
+
+        // Arbre sur les blocs de TAILLE_BLOC produits consécutifs : feuille feuilles + b pour le bloc b
+        constexpr int TAILLE_BLOC = 16;
+        const int nbBlocs = (n + TAILLE_BLOC - 1) / TAILLE_BLOC;
+        int feuilles = 1;
+        while (feuilles < nbBlocs) feuilles <<= 1;
+        std::vector<double> poidsMin(2 * static_cast<size_t>(feuilles), std::numeric_limits<double>::infinity());
+        std::vector<double> valeurMax(2 * static_cast<size_t>(feuilles), -std::numeric_limits<double>::infinity());
+        auto calculerBloc = [&](int b) {
+            double pMin = std::numeric_limits<double>::infinity(), vMax = -pMin;
+            for (int i = b * TAILLE_BLOC; i < std::min(n, (b + 1) * TAILLE_BLOC); ++i) {
+                if (dansSac[i]) continue;
+                pMin = std::min(pMin, produits[i].poids);
+                vMax = std::max(vMax, produits[i].valeur);
+            }
+            poidsMin[feuilles + b] = pMin;
+            valeurMax[feuilles + b] = vMax;
+        };
+        auto calculerNoeud = [&](int k) {
+            poidsMin[k] = std::min(poidsMin[2 * k], poidsMin[2 * k + 1]);
+            valeurMax[k] = std::max(valeurMax[2 * k], valeurMax[2 * k + 1]);
+        };
+        for (int b = 0; b < nbBlocs; ++b) calculerBloc(b);
+        for (int k = feuilles - 1; k > 0; --k) calculerNoeud(k);
+        auto majArbre = [&](int i) {
+            calculerBloc(i / TAILLE_BLOC);
+            for (int k = (feuilles + i / TAILLE_BLOC) >> 1; k > 0; k >>= 1) calculerNoeud(k);
+        };
+        std::vector<int> pile;
+        // Produit hors du sac de poids <= libre et de valeur > seuil la plus forte, -1 s'il n'y en a pas
+        auto plusPrecieuxQuiTient = [&](double libre, double seuil) {
+            int meilleur = -1;
+            pile.assign(1, 1);
+            while (!pile.empty()) {
+                const int k = pile.back();
+                pile.pop_back();
+                if (poidsMin[k] > libre || valeurMax[k] <= seuil) continue;
+                if (k >= feuilles) {
+                    const int b = k - feuilles;
+                    for (int i = b * TAILLE_BLOC; i < std::min(n, (b + 1) * TAILLE_BLOC); ++i) {
+                        if (!dansSac[i] && produits[i].poids <= libre && produits[i].valeur > seuil) {
+                            seuil = produits[i].valeur;
+                            meilleur = i;
+                        }
+                    }
+                    continue;
+                }
+                // Le fils le plus précieux est exploré d'abord pour relever le seuil au plus tôt
+                const bool gaucheDabord = valeurMax[2 * k] >= valeurMax[2 * k + 1];
+                pile.push_back(gaucheDabord ? 2 * k + 1 : 2 * k);
+                pile.push_back(gaucheDabord ? 2 * k : 2 * k + 1);
+            }
+            return meilleur;
+        };
+
+        std::vector<int> dedans, dehors;
+        for (int mouvement = 0; mouvement < maxMouvements; ++mouvement) {
+            // Voisinages : fin de l'ordre par ratio pour le sac, début pour le reste
+            dedans.assign(dedansTries.rbegin(), dedansTries.rbegin() + std::min(LARGEUR_VOISINAGE, dedansTries.size()));
+            while (premierDehors < ordre.size() && dansSac[ordre[premierDehors]]) ++premierDehors;
+            dehors.clear();
+            for (size_t r = premierDehors; r < ordre.size() && dehors.size() < LARGEUR_VOISINAGE; ++r) {
+                if (!dansSac[ordre[r]]) dehors.push_back(ordre[r]);
+            }
+
+            double meilleurGain = 1e-12;
+            int entre = -1, sort1 = -1, sort2 = -1;
+            const double libre = capacite - poidsTotal;
+
+            // Ajout : le produit le plus précieux qui tient encore, sur tous les produits hors du sac
+            const int ajout = plusPrecieuxQuiTient(libre, meilleurGain);
+            if (ajout >= 0) {
+                meilleurGain = produits[ajout].valeur;
+                entre = ajout;
+            }
+
+            for (size_t a = 0; a < dedans.size(); ++a) {
+                const Produit& pa = produits[dedans[a]];
+                for (int j : dehors) {
+                    const Produit& pj = produits[j];
+                    // Échange 1-1
+                    if (pj.poids - pa.poids <= libre && pj.valeur - pa.valeur > meilleurGain) {
+                        meilleurGain = pj.valeur - pa.valeur;
+                        entre = j;
+                        sort1 = dedans[a];
+                        sort2 = -1;
+                    }
+                    // Échange 2-1
+                    for (size_t b = a + 1; b < dedans.size(); ++b) {
+                        const Produit& pb = produits[dedans[b]];
+                        if (pj.poids - pa.poids - pb.poids <= libre && pj.valeur - pa.valeur - pb.valeur > meilleurGain) {
+                            meilleurGain = pj.valeur - pa.valeur - pb.valeur;
+                            entre = j;
+                            sort1 = dedans[a];
+                            sort2 = dedans[b];
+                        }
+                    }
+                }
+            }
+
+            if (entre < 0) break;
+            for (int sortant : { sort1, sort2 }) {
+                if (sortant < 0) continue;
+                dansSac[sortant] = 0;
+                poidsTotal -= produits[sortant].poids;
+                valeurTotale -= produits[sortant].valeur;
+                dedansTries.erase(std::lower_bound(dedansTries.begin(), dedansTries.end(), sortant, avantParRatio));
+                majArbre(sortant);
+                const size_t rang = std::lower_bound(ordre.begin(), ordre.end(), sortant, avantParRatio) - ordre.begin();
+                premierDehors = std::min(premierDehors, rang);
+            }
+            dansSac[entre] = 1;
+            poidsTotal += produits[entre].poids;
+            valeurTotale += produits[entre].valeur;
+            dedansTries.insert(std::lower_bound(dedansTries.begin(), dedansTries.end(), entre, avantParRatio), entre);
+            majArbre(entre);
+        }
+
+        indices.clear();
+        for (size_t i = 0; i < produits.size(); ++i) {
+            if (dansSac[i]) indices.push_back(static_cast<int>(i));
+        }
+        return valeurTotale - valeurInitiale;
+    }
+
+
+
+    //Q5****
+    std::vector<Produit> resoudreSacADosRandomise(int N = 2) {
+        return produitsSelectionnes(resoudreSacADosRandomiseIndices(N));
+    }
+
+    // Parcourt l'ordre par ratio précalculé dans GestionDonnees : ni copie ni tri des produits
+    std::vector<int> resoudreSacADosRandomiseIndices(int N = 2) {
+        std::vector<int> ordreLocal;
+        const std::vector<int>& ordre = ordreParRatio(ordreLocal);
+        const std::vector<Produit>& produits = donnees.produits;
+
+        std::vector<int> solution;
+        std::vector<int> candidats;
+        candidats.reserve(N);
+        double capaciteUtilisee = 0.0;
+        std::uniform_int_distribution<> dist(0, N - 1);
+
+        for (size_t i = 0; i < ordre.size(); i += N) {
+            candidats.clear();
+            for (size_t j = i; j < i + N && j < ordre.size(); ++j) {
+                if (capaciteUtilisee + produits[ordre[j]].poids <= donnees.capaciteMax) {
+                    candidats.push_back(ordre[j]);
+                }
+            }
+            if (!candidats.empty()) {
+                int choix = dist(gen) % candidats.size();
+                solution.push_back(candidats[choix]);
+                capaciteUtilisee += produits[candidats[choix]].poids;
+            }
+        }
+        return solution;
+    }
+
+    // Sac à dos 0/1 exact par programmation dynamique. Les poids sont ramenés à des entiers
+    // (poids * echelle arrondi au supérieur, capacité * echelle arrondie à l'inférieur), la solution
+    // est donc toujours réalisable et optimale pour les poids arrondis. Un seul tableau de capacité
+    // par sous-problème : les produits choisis sont retrouvés en coupant récursivement la liste
+    // en deux (méthode de Hirschberg), soit O(n * C) en temps et O(C) en mémoire.
+    std::vector<Produit> resoudreSacADosExact(double echelle = 1.0) {
+        return produitsSelectionnes(resoudreSacADosExactIndices(echelle));
+    }
+
+    std::vector<int> resoudreSacADosExactIndices(double echelle = 1.0) {
+        const long long capacite = static_cast<long long>(std::floor(donnees.capaciteMax * echelle + 1e-9));
+        std::vector<ObjetDP> objets;
+        for (size_t i = 0; i < donnees.produits.size(); ++i) {
+            const long long poids = static_cast<long long>(std::ceil(donnees.produits[i].poids * echelle - 1e-9));
+            if (poids <= capacite) objets.push_back({ static_cast<size_t>(std::max(0LL, poids)), donnees.produits[i].valeur, static_cast<int>(i) });
+        }
+
+        std::vector<int> solution;
+        if (capacite < 0 || objets.empty()) return solution;
+        TablesDP tables;
+        reconstruireDP(objets, 0, objets.size(), static_cast<size_t>(capacite), tables, solution);
+        std::sort(solution.begin(), solution.end());
+        return solution;
+    }
+
+    // Branch and bound en profondeur sur les produits triés par ratio, élagué par la borne de
+    // Dantzig (relaxation continue) et amorcé avec la solution du glouton randomisé.
+    ResultatSacExact resoudreSacADosBranchAndBound(long long limiteNoeuds = 10000000, double limiteSecondes = 1.0) {
+        std::vector<int> ordreLocal;
+        const std::vector<int>& ordre = ordreParRatio(ordreLocal);
+        std::vector<int> candidats;
+        candidats.reserve(ordre.size());
+        for (int i : ordre) {
+            if (donnees.produits[i].poids <= donnees.capaciteMax) candidats.push_back(i);
+        }
+        return brancherEtBorner(candidats, donnees.capaciteMax, resoudreSacADosRandomiseIndices(), limiteNoeuds, limiteSecondes);
+    }
+
+    // Algorithme à noyau (dans l'esprit d'expknap) : l'objet critique de la relaxation continue est
+    // trouvé par partitions successives autour d'un ratio pivot, en O(n) sans trier les produits.
+    // Les objets au-dessus du noyau sont pris, ceux en dessous écartés, et seul le noyau (triés par
+    // ratio) passe au branch and bound. La borne de Dembo-Hammer de chaque objet hors noyau,
+    // z_LP - |valeur - ratioCritique * poids|, prouve qu'il ne peut pas changer d'état ; sinon le
+    // noyau est doublé et résolu à nouveau.
+    ResultatSacExact resoudreSacADosNoyau(long long limiteNoeuds = 10000000, double limiteSecondes = 1.0, size_t tailleNoyau = 32) {
+        const std::vector<Produit>& produits = donnees.produits;
+        std::vector<int> objets;
+        objets.reserve(produits.size());
+        for (size_t i = 0; i < produits.size(); ++i) {
+            if (produits[i].poids <= donnees.capaciteMax) objets.push_back(static_cast<int>(i));
+        }
+
+        const size_t n = objets.size();
+        const size_t critique = trouverObjetCritique(objets, donnees.capaciteMax);
+
+        ResultatSacExact resultat;
+        if (critique == n) {
+            // Tout tient dans le sac
+            resultat.indices = objets;
+            for (int i : objets) resultat.valeur += produits[i].valeur;
+            resultat.borneSuperieure = resultat.valeur;
+            std::sort(resultat.indices.begin(), resultat.indices.end());
+            return resultat;
+        }
+
+        double poidsPris = 0.0, valeurPrise = 0.0;
+        for (size_t k = 0; k < critique; ++k) {
+            poidsPris += produits[objets[k]].poids;
+            valeurPrise += produits[objets[k]].valeur;
+        }
+        const Produit& objetCritique = produits[objets[critique]];
+        const double ratioCritique = objetCritique.ratio;
+        const double borneLP = valeurPrise + (donnees.capaciteMax - poidsPris) * ratioCritique;
+        auto parRatio = [&](int a, int b) { return produits[a].ratio > produits[b].ratio; };
+
+        const auto echeance = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(limiteSecondes));
+        for (;;) {
+            // Noyau : les tailleNoyau objets pris de plus faible ratio, l'objet critique et les tailleNoyau suivants
+            const size_t debutNoyau = critique - std::min(critique, tailleNoyau);
+            const size_t finNoyau = critique + 1 + std::min(n - critique - 1, tailleNoyau);
+            // (l'objet critique peut être le dernier : aucun objet après lui à partitionner)
+            if (debutNoyau < critique) std::nth_element(objets.begin(), objets.begin() + debutNoyau, objets.begin() + critique, parRatio);
+            if (critique + 1 < finNoyau) std::nth_element(objets.begin() + critique + 1, objets.begin() + (finNoyau - 1), objets.end(), parRatio);
+
+            double poidsFixe = 0.0, valeurFixe = 0.0;
+            for (size_t k = 0; k < debutNoyau; ++k) {
+                poidsFixe += produits[objets[k]].poids;
+                valeurFixe += produits[objets[k]].valeur;
+            }
+
+            std::vector<int> noyau(objets.begin() + debutNoyau, objets.begin() + finNoyau);
+            std::sort(noyau.begin(), noyau.end(), parRatio);
+            const double capaciteNoyau = donnees.capaciteMax - poidsFixe;
+            std::vector<int> initiale;
+            double poidsInitial = 0.0;
+            for (int i : noyau) {
+                if (poidsInitial + produits[i].poids <= capaciteNoyau) {
+                    initiale.push_back(i);
+                    poidsInitial += produits[i].poids;
+                }
+            }
+
+            const double secondesRestantes = std::chrono::duration<double>(echeance - std::chrono::steady_clock::now()).count();
+            ResultatSacExact sousProbleme = brancherEtBorner(noyau, capaciteNoyau, initiale, limiteNoeuds, std::max(0.0, secondesRestantes));
+            resultat.noeuds += sousProbleme.noeuds;
+            if (resultat.indices.empty() || valeurFixe + sousProbleme.valeur > resultat.valeur) {
+                resultat.valeur = valeurFixe + sousProbleme.valeur;
+                resultat.indices.assign(objets.begin(), objets.begin() + debutNoyau);
+                resultat.indices.insert(resultat.indices.end(), sousProbleme.indices.begin(), sousProbleme.indices.end());
+            }
+
+            // Plus petit écart réduit hors noyau : s'il ne permet pas de dépasser la solution, elle est optimale
+            double ecartMin = std::numeric_limits<double>::infinity();
+            for (size_t k = 0; k < n; ++k) {
+                if (k == debutNoyau) k = finNoyau;
+                if (k >= n) break;
+                const Produit& p = produits[objets[k]];
+                ecartMin = std::min(ecartMin, std::abs(p.valeur - ratioCritique * p.poids));
+            }
+            const bool prouve = sousProbleme.optimal && borneLP - ecartMin <= resultat.valeur + 1e-9;
+            const bool toutExplore = debutNoyau == 0 && finNoyau == n;
+            if (prouve || (toutExplore && sousProbleme.optimal)) {
+                resultat.optimal = true;
+                resultat.borneSuperieure = resultat.valeur;
+                break;
+            }
+            if (toutExplore || !sousProbleme.optimal || std::chrono::steady_clock::now() >= echeance) {
+                resultat.optimal = false;
+                resultat.borneSuperieure = std::max(resultat.valeur, borneLP);
+                break;
+            }
+            tailleNoyau *= 2;
+        }
+
+        resultat.ecart = resultat.borneSuperieure > 0 ? (resultat.borneSuperieure - resultat.valeur) / resultat.borneSuperieure : 0.0;
+        std::sort(resultat.indices.begin(), resultat.indices.end());
+        return resultat;
+    }
+
+    std::vector<Produit> produitsSelectionnes(const std::vector<int>& indices) const {
+        std::vector<Produit> sac;
+        sac.reserve(indices.size());
+        for (int i : indices) sac.push_back(donnees.produits[i]);
+        return sac;
+    }
+
+    // Ordre par ratio de l'instance, ou calculé dans ordreLocal si les produits ont été remplis à la main
+    const std::vector<int>& ordreParRatio(std::vector<int>& ordreLocal) const {
+        if (donnees.ordreRatio.size() == donnees.produits.size()) return donnees.ordreRatio;
+        ordreLocal = GestionDonnees::trierParRatio(donnees.produits);
+        return ordreLocal;
+    }
+
+private:
+    // Réordonne objets pour que [0, critique) soient les objets pris par la relaxation continue
+    // (ratios >= à celui de l'objet critique) et (critique, n) les autres ; renvoie n si tout tient.
+    // Partition à trois voies autour d'un ratio pivot, en O(n) en moyenne.
+    size_t trouverObjetCritique(std::vector<int>& objets, double capacite) {
+        const std::vector<Produit>& produits = donnees.produits;
+        size_t debut = 0, fin = objets.size();
+        std::uniform_int_distribution<size_t> hasard;
+        while (debut < fin) {
+            const double pivot = produits[objets[debut + hasard(gen) % (fin - debut)]].ratio;
+            auto finPlusGrands = std::partition(objets.begin() + debut, objets.begin() + fin, [&](int i) { return produits[i].ratio > pivot; });
+            auto finEgaux = std::partition(finPlusGrands, objets.begin() + fin, [&](int i) { return produits[i].ratio == pivot; });
+            const size_t a = finPlusGrands - objets.begin();
+            const size_t b = finEgaux - objets.begin();
+
+            double poidsPlusGrands = 0.0;
+            for (size_t k = debut; k < a; ++k) poidsPlusGrands += produits[objets[k]].poids;
+            if (poidsPlusGrands > capacite) {
+                fin = a;
+                continue;
+            }
+            capacite -= poidsPlusGrands;
+            for (size_t k = a; k < b; ++k) {
+                if (produits[objets[k]].poids > capacite) return k;
+                capacite -= produits[objets[k]].poids;
+            }
+            debut = b;
+        }
+        return objets.size();
+    }
+
+    // Exploration en profondeur ; poidsCumules/valeursCumulees permettent de calculer la borne
+    // de Dantzig d'un noeud en O(log n) (recherche de l'objet critique)
+    struct ExplorationBB {
+        const std::vector<int>* ordre;
+        std::vector<double> poids, valeurs, poidsCumules, valeursCumulees;
+        std::vector<int> chemin, meilleurChemin;
+        double meilleureValeur = 0.0;
+        double borneOuverte = 0.0; // plus grande borne des noeuds laissés ouverts par une limite
+        long long noeuds = 0;
+        long long limiteNoeuds = 0;
+        std::chrono::steady_clock::time_point echeance;
+        bool arret = false;
+
+        double borne(size_t k, double capacite, double valeur) const {
+            const size_t n = poids.size();
+            const double cible = poidsCumules[k] + capacite;
+            const size_t critique = std::upper_bound(poidsCumules.begin() + k, poidsCumules.end(), cible) - poidsCumules.begin() - 1;
+            double b = valeur + valeursCumulees[critique] - valeursCumulees[k];
+            if (critique < n) b += (cible - poidsCumules[critique]) * valeurs[critique] / poids[critique];
+            return b;
+        }
+
+        // Pile explicite : la branche "prendre k" empile un cadre, la branche "laisser k" réutilise
+        // le cadre courant, la profondeur reste bornée par le nombre d'objets pris
+        struct Cadre {
+            size_t k;
+            double capacite;
+            double valeur;
+            bool pris;      // le cadre a ajouté un objet à chemin
+            bool branche;   // la branche "prendre k" a déjà été explorée
+        };
+
+        void explorer(double capaciteInitiale) {
+            std::vector<Cadre> pile;
+            pile.push_back({ 0, capaciteInitiale, 0.0, false, false });
+            while (!pile.empty()) {
+                Cadre& c = pile.back();
+                bool termine = false;
+                if (!c.branche) {
+                    if (!arret && (++noeuds >= limiteNoeuds || ((noeuds & 4095) == 0 && std::chrono::steady_clock::now() >= echeance))) {
+                        arret = true;
+                    }
+                    if (arret) {
+                        borneOuverte = std::max(borneOuverte, borne(c.k, c.capacite, c.valeur));
+                        termine = true;
+                    }
+                    else {
+                        if (c.valeur > meilleureValeur) {
+                            meilleureValeur = c.valeur;
+                            meilleurChemin = chemin;
+                        }
+                        termine = c.k == poids.size() || borne(c.k, c.capacite, c.valeur) <= meilleureValeur + 1e-9;
+                    }
+
+                    if (!termine) {
+                        c.branche = true;
+                        if (poids[c.k] <= c.capacite) {
+                            const Cadre enfant{ c.k + 1, c.capacite - poids[c.k], c.valeur + valeurs[c.k], true, false };
+                            chemin.push_back(c.k);
+                            pile.push_back(enfant);
+                            continue;
+                        }
+                    }
+                }
+
+                if (!termine) {
+                    // Branche "laisser k"
+                    ++c.k;
+                    c.branche = false;
+                    continue;
+                }
+
+                if (c.pris) chemin.pop_back();
+                pile.pop_back();
+            }
+        }
+    };
+
+    ResultatSacExact brancherEtBorner(const std::vector<int>& ordre, double capacite, const std::vector<int>& initiale, long long limiteNoeuds, double limiteSecondes) {
+        ExplorationBB bb;
+        const size_t n = ordre.size();
+        bb.ordre = &ordre;
+        bb.poids.resize(n);
+        bb.valeurs.resize(n);
+        bb.poidsCumules.assign(n + 1, 0.0);
+        bb.valeursCumulees.assign(n + 1, 0.0);
+        for (size_t k = 0; k < n; ++k) {
+            bb.poids[k] = donnees.produits[ordre[k]].poids;
+            bb.valeurs[k] = donnees.produits[ordre[k]].valeur;
+            bb.poidsCumules[k + 1] = bb.poidsCumules[k] + bb.poids[k];
+            bb.valeursCumulees[k + 1] = bb.valeursCumulees[k] + bb.valeurs[k];
+        }
+        bb.limiteNoeuds = limiteNoeuds;
+        bb.echeance = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(limiteSecondes));
+
+        ResultatSacExact resultat;
+        resultat.indices = initiale;
+        for (int i : initiale) bb.meilleureValeur += donnees.produits[i].valeur;
+
+        bb.explorer(capacite);
+
+        if (!bb.meilleurChemin.empty()) {
+            resultat.indices.clear();
+            for (int k : bb.meilleurChemin) resultat.indices.push_back(ordre[k]);
+            std::sort(resultat.indices.begin(), resultat.indices.end());
+        }
+        resultat.valeur = bb.meilleureValeur;
+        resultat.optimal = !bb.arret;
+        resultat.borneSuperieure = resultat.optimal ? resultat.valeur : std::max(resultat.valeur, bb.borneOuverte);
+        resultat.ecart = resultat.borneSuperieure > 0 ? (resultat.borneSuperieure - resultat.valeur) / resultat.borneSuperieure : 0.0;
+        resultat.noeuds = bb.noeuds;
+        return resultat;
+    }
+
+    struct ObjetDP {
+        size_t poids;
+        double valeur;
+        int indice;
+    };
+
+    struct TablesDP {
+        std::vector<double> gauche, droite, travail;
+    };
+
+    // profil[c] = meilleure valeur des objets [debut, fin) pour une capacité c
+    static void profilDP(const std::vector<ObjetDP>& objets, size_t debut, size_t fin, size_t capacite, std::vector<double>& profil, std::vector<double>& travail) {
+        profil.assign(capacite + 1, 0.0);
+        travail.resize(capacite + 1);
+        for (size_t k = debut; k < fin; ++k) {
+            majMaxDecale(profil.data(), travail.data(), capacite + 1, objets[k].poids, objets[k].valeur);
+            profil.swap(travail);
+        }
+    }
+
+    void reconstruireDP(const std::vector<ObjetDP>& objets, size_t debut, size_t fin, size_t capacite, TablesDP& tables, std::vector<int>& solution) {
+        if (fin - debut == 1) {
+            if (objets[debut].poids <= capacite) solution.push_back(objets[debut].indice);
+            return;
+        }
+
+        const size_t milieu = (debut + fin) / 2;
+        profilDP(objets, debut, milieu, capacite, tables.gauche, tables.travail);
+        profilDP(objets, milieu, fin, capacite, tables.droite, tables.travail);
+
+        size_t meilleurePart = 0;
+        double meilleureValeur = -1.0;
+        for (size_t c = 0; c <= capacite; ++c) {
+            const double valeur = tables.gauche[c] + tables.droite[capacite - c];
+            if (valeur > meilleureValeur) {
+                meilleureValeur = valeur;
+                meilleurePart = c;
+            }
+        }
+
+        reconstruireDP(objets, debut, milieu, meilleurePart, tables, solution);
+        reconstruireDP(objets, milieu, fin, capacite - meilleurePart, tables, solution);
+    }
+
+public:
+    // Problème P2 : construction(s) GRASP selon parametres, la tournée la moins coûteuse est gardée
+    std::vector<int> resoudreTournee() {
+        return donnees.avecEnergie([&](const auto& E) { return resoudreTournee(E); });
+    }
+
+    template <typename Energie>
+    std::vector<int> resoudreTournee(const Energie& E) {
+        const ParametresResolution& p = parametres;
+        const int nbVilles = static_cast<int>(E.taille());
+        if (nbVilles > 1 && nbVilles <= std::min(p.villesMaxHeldKarp, VILLES_MAX_HELD_KARP)) {
+            if (memoireHeldKarp(nbVilles) > p.memoireMaxHeldKarp) {
+                std::cerr << "Attention: Held-Karp sur " << nbVilles << " villes demande "
+                          << (memoireHeldKarp(nbVilles) >> 20) << " Mo (limite " << (p.memoireMaxHeldKarp >> 20)
+                          << " Mo), tournée heuristique" << std::endl;
+            } else {
+                std::vector<int> tournee = resoudreTourneeHeldKarp(E);
+                if (!tournee.empty()) return tournee;
+                std::cerr << "Attention: Held-Karp abandonné, tournée heuristique" << std::endl;
+            }
+        }
+
+        AlphaReactif reactif(false);
+        std::vector<int> meilleure;
+        double meilleureEnergie = std::numeric_limits<double>::infinity();
+        for (int iteration = 0; iteration < std::max(1, p.iterationsGrasp); ++iteration) {
+            const size_t k = p.alphaReactif ? reactif.tirer(gen) : 0;
+            const double alpha = p.alphaReactif ? AlphaReactif::VALEURS[k] : p.alpha;
+            std::vector<int> tournee = (p.listeRestreinte == ListeRestreinte::Valeur)
+                ? construireTourneeGrasp(E, alpha)
+                : resoudreTourneeRandomisee(E, p.tailleListe);
+            if (p.rechercheLocaleTournee) ameliorerTournee(E, tournee);
+
+            const double energie = energieTournee(E, tournee);
+            if (p.alphaReactif) reactif.enregistrer(k, energie);
+            if (energie < meilleureEnergie) {
+                meilleureEnergie = energie;
+                meilleure = std::move(tournee);
+            }
+        }
+        if (p.tempsLK > 0.0) optimiserTourneeLK(E, meilleure, p.tempsLK);
+        return meilleure;
+    }
+
+    // Construction GRASP de P2 avec liste restreinte par valeur : la prochaine ville est tirée
+    // parmi les villes non visitées à moins de alpha * (max - min) de la plus proche. Les énergies
+    // ne sont lues que vers les villes restantes (VillesRestantes, energiesVers).
+    template <typename Energie>
+    std::vector<int> construireTourneeGrasp(const Energie& E, double alpha) {
+        const int nbVilles = static_cast<int>(donnees.villes.size());
+        std::vector<double> energies(nbVilles);
+        VillesRestantes restantes(nbVilles);
+        std::vector<int> liste;
+        std::vector<int> tournee;
+        tournee.reserve(nbVilles);
+        int villeActuelle = 0;
+        tournee.push_back(villeActuelle);
+        restantes.retirer(villeActuelle);
+
+        while (restantes.taille() > 0) {
+            const int nb = restantes.taille();
+            E.energiesVers(villeActuelle, restantes.donnees(), nb, energies.data());
+            double dMin = std::numeric_limits<double>::infinity(), dMax = -dMin;
+            for (int k = 0; k < nb; ++k) {
+                dMin = std::min(dMin, energies[k]);
+                dMax = std::max(dMax, energies[k]);
+            }
+            const double seuil = dMin + alpha * (dMax - dMin);
+            liste.clear();
+            for (int k = 0; k < nb; ++k) {
+                if (energies[k] <= seuil) liste.push_back(restantes.ville(k));
+            }
+
+            villeActuelle = liste[std::uniform_int_distribution<size_t>(0, liste.size() - 1)(gen)];
+            restantes.retirer(villeActuelle);
+            tournee.push_back(villeActuelle);
+        }
+        return tournee;
+    }
+
+    // Recherche locale sur une tournée complète ; renvoie le gain d'énergie. Le 2-opt inverse des
+    // segments, il n'est correct que sur une matrice symétrique (détectée au chargement) ; sinon seul
+    // l'Or-opt, qui conserve le sens de parcours, est appliqué.
+    template <typename Energie>
+    double ameliorerTournee(const Energie& E, std::vector<int>& tournee) {
+        if (!donnees.matriceSymetrique) return ameliorerTourneeOrOpt(E, tournee);
+        double gain = ameliorerTournee2Opt(E, tournee);
+        for (;;) {
+            const double gainOrOpt = ameliorerTourneeOrOpt(E, tournee);
+            if (gainOrOpt <= 0.0) break;
+            gain += gainOrOpt + ameliorerTournee2Opt(E, tournee);
+        }
+        return gain;
+    }
+
+    double ameliorerTournee(std::vector<int>& tournee) {
+        return donnees.avecEnergie([&](const auto& E) { return ameliorerTournee(E, tournee); });
+    }
+
+    // Tournée optimale par programmation dynamique de Held-Karp sur les villes 1 .. n-1 (m = n - 1) :
+    // couts[masque * m + j] est l'énergie minimale d'un chemin partant de 0, visitant exactement les
+    // villes de masque et finissant en j, predecesseur[masque * m + j] l'avant-dernière ville (octet).
+    // Les masques sont traités couche par couche (même nombre de villes), chaque couche en parallèle.
+    // O(2^m * m^2) en temps, 9 octets par case : environ 90 Mo pour 20 villes, 3,6 Go pour 25.
+    // La tournée commence en 0 et y revient, comme dans calculerResultats.
+    template <typename Energie>
+    std::vector<int> resoudreTourneeHeldKarp(const Energie& E) {
+        const int n = static_cast<int>(E.taille());
+        std::vector<int> tournee = { 0 };
+        if (n <= 1) return tournee;
+        if (n > VILLES_MAX_HELD_KARP) {
+            std::cerr << "Erreur: Held-Karp limité à " << VILLES_MAX_HELD_KARP << " villes" << std::endl;
+            return {};
+        }
+
+        const int m = n - 1;
+        std::vector<double> d(static_cast<size_t>(n) * n);
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) d[i * n + j] = E(i, j);
+        }
+
+        const size_t nbMasques = size_t(1) << m;
+        std::unique_ptr<double[]> couts;
+        std::unique_ptr<uint8_t[]> predecesseur;
+        try {
+            couts.reset(new double[nbMasques * m]);
+            predecesseur.reset(new uint8_t[nbMasques * m]);
+        } catch (const std::bad_alloc&) {
+            std::cerr << "Erreur: mémoire insuffisante pour Held-Karp sur " << n << " villes ("
+                      << (memoireHeldKarp(n) >> 20) << " Mo)" << std::endl;
+            return {};
+        }
+        constexpr uint8_t DEPOT = 0xFF;
+        for (int j = 0; j < m; ++j) {
+            couts[(size_t(1) << j) * m + j] = d[j + 1];
+            predecesseur[(size_t(1) << j) * m + j] = DEPOT;
+        }
+
+        std::vector<uint32_t> couche;
+        for (int k = 2; k <= m; ++k) {
+            // Masques à k bits dans l'ordre croissant (astuce de Gosper)
+            couche.clear();
+            for (uint32_t masque = (1u << k) - 1; masque < nbMasques; ) {
+                couche.push_back(masque);
+                const uint32_t c = masque & (0u - masque), r = masque + c;
+                masque = (((r ^ masque) >> 2) / c) | r;
+            }
+
+            constexpr size_t TAILLE_BLOC = 1024;
+            executerEnParallele((couche.size() + TAILLE_BLOC - 1) / TAILLE_BLOC, 0, [&](size_t bloc) {
+                const size_t fin = std::min(couche.size(), (bloc + 1) * TAILLE_BLOC);
+                for (size_t b = bloc * TAILLE_BLOC; b < fin; ++b) {
+                    const uint32_t masque = couche[b];
+                    for (int j = 0; j < m; ++j) {
+                        if (!(masque >> j & 1u)) continue;
+                        const size_t precedent = size_t(masque ^ (1u << j)) * m;
+                        double meilleur = std::numeric_limits<double>::infinity();
+                        int arg = 0;
+                        for (int i = 0; i < m; ++i) {
+                            if (!(masque >> i & 1u) || i == j) continue;
+                            const double c = couts[precedent + i] + d[(i + 1) * n + j + 1];
+                            if (c < meilleur) {
+                                meilleur = c;
+                                arg = i;
+                            }
+                        }
+                        couts[size_t(masque) * m + j] = meilleur;
+                        predecesseur[size_t(masque) * m + j] = static_cast<uint8_t>(arg);
+                    }
+                }
+                });
+        }
+
+        const size_t complet = nbMasques - 1;
+        int derniere = 0;
+        double meilleur = std::numeric_limits<double>::infinity();
+        for (int j = 0; j < m; ++j) {
+            const double c = couts[complet * m + j] + d[(j + 1) * n];
+            if (c < meilleur) {
+                meilleur = c;
+                derniere = j;
+            }
+        }
+
+        // Remontée des prédécesseurs depuis la dernière ville, puis mise à l'endroit
+        std::vector<int> chemin;
+        size_t masque = complet;
+        for (int j = derniere; j != DEPOT; ) {
+            chemin.push_back(j + 1);
+            const int precedente = predecesseur[masque * m + j];
+            masque ^= size_t(1) << j;
+            j = precedente;
+        }
+        tournee.insert(tournee.end(), chemin.rbegin(), chemin.rend());
+        return tournee;
+    }
+
+    std::vector<int> resoudreTourneeHeldKarp() {
+        return donnees.avecEnergie([&](const auto& E) { return resoudreTourneeHeldKarp(E); });
+    }
+
+    // Borne inférieure de Held-Karp de l'énergie d'une tournée : 1-arbre minimal (arbre couvrant des
+    // villes 1 .. n-1 plus les deux arêtes les moins chères de la ville 0) pour les énergies
+    // E(i, j) + pi[i] + pi[j], les multiplicateurs pi étant ajustés par sous-gradient (degré - 2).
+    // Chaque itération est un Prim en O(N^2) qui lit une ligne à la fois, soit O(N) en mémoire.
+    // Sur matrice asymétrique, l'arête {i, j} vaut min(E(i, j), E(j, i)), ce qui reste une borne.
+    // majorant, l'énergie d'une tournée connue, règle le pas du sous-gradient.
+    template <typename Energie>
+    double borneInferieureTournee(const Energie& E, double majorant, int iterations, unsigned int nbThreads = 1) const {
+        const int n = static_cast<int>(E.taille());
+        if (n < 3 || iterations <= 0) return 0.0;
+        const bool symetrique = donnees.matriceSymetrique;
+        std::vector<double> pi(n, 0.0), cle(n), tampon(n), arete(n);
+        std::vector<int> parent(n), degre(n);
+        std::vector<char> dansArbre(n);
+
+        // arete[v] = poids de {u, v} sans les multiplicateurs
+        auto lireAretes = [&](int u) {
+            const double* ligne = E.ligneEnergies(u, tampon.data());
+            for (int v = 0; v < n; ++v) arete[v] = symetrique ? ligne[v] : std::min(ligne[v], E(v, u));
+        };
+
+        // Prim : chaque thread tient les clés d'une tranche de villes et y cherche son minimum ; le
+        // thread 0 choisit la ville suivante entre deux barrières. Les minima sont départagés par indice
+        // comme en séquentiel, la borne ne dépend donc pas du nombre de threads.
+        constexpr int VILLES_MIN_PAR_THREAD = 2048;
+        const unsigned int nbTranches = std::max(1u, std::min(nbThreadsEffectif(n, nbThreads), static_cast<unsigned int>(n / VILLES_MIN_PAR_THREAD)));
+        std::vector<int> minimaTranches(nbTranches);
+
+        double meilleure = 0.0;
+        double lambda = 2.0;
+        int sansProgres = 0;
+        for (int iteration = 0; iteration < iterations; ++iteration) {
+            std::fill(cle.begin(), cle.end(), std::numeric_limits<double>::infinity());
+            std::fill(dansArbre.begin(), dansArbre.end(), 0);
+            std::fill(degre.begin(), degre.end(), 0);
+            double valeur = 0.0;
+            int u = 1;
+            auto entrer = [&](int v) {
+                dansArbre[v] = 1;
+                valeur += cle[v];
+                if (parent[v] >= 0) {
+                    ++degre[v];
+                    ++degre[parent[v]];
+                }
+            };
+            cle[1] = 0.0;
+            parent[1] = -1;
+            entrer(1);
+
+            Barriere barriere(nbTranches);
+            executerEnParalleleParThread(nbTranches, nbTranches, [&](size_t, unsigned int t) {
+                const int debut = 1 + static_cast<int>(static_cast<long long>(n - 1) * t / nbTranches);
+                const int fin = 1 + static_cast<int>(static_cast<long long>(n - 1) * (t + 1) / nbTranches);
+                for (int ajoutees = 1; ajoutees < n - 1; ++ajoutees) {
+                    const int courante = u;
+                    int suivante = -1;
+                    for (int v = debut; v < fin; ++v) {
+                        if (dansArbre[v]) continue;
+                        const double a = symetrique ? E(courante, v) : std::min(E(courante, v), E(v, courante));
+                        const double w = a + pi[courante] + pi[v];
+                        if (w < cle[v]) {
+                            cle[v] = w;
+                            parent[v] = courante;
+                        }
+                        if (suivante < 0 || cle[v] < cle[suivante]) suivante = v;
+                    }
+                    minimaTranches[t] = suivante;
+                    barriere.attendre();
+                    if (t == 0) {
+                        int choisie = -1;
+                        for (int m : minimaTranches) {
+                            if (m >= 0 && (choisie < 0 || cle[m] < cle[choisie])) choisie = m;
+                        }
+                        u = choisie;
+                        entrer(u);
+                    }
+                    barriere.attendre();
+                }
+                });
+
+            // Les deux arêtes les moins chères de la ville 0
+            lireAretes(0);
+            int premiere = -1, seconde = -1;
+            for (int v = 1; v < n; ++v) {
+                const double w = arete[v] + pi[v];
+                if (premiere < 0 || w < arete[premiere] + pi[premiere]) {
+                    seconde = premiere;
+                    premiere = v;
+                }
+                else if (seconde < 0 || w < arete[seconde] + pi[seconde]) {
+                    seconde = v;
+                }
+            }
+            valeur += arete[premiere] + arete[seconde] + pi[premiere] + pi[seconde] + 2.0 * pi[0];
+            degre[0] = 2;
+            ++degre[premiere];
+            ++degre[seconde];
+            for (int v = 0; v < n; ++v) valeur -= 2.0 * pi[v];
+
+            if (valeur > meilleure + 1e-9) {
+                meilleure = valeur;
+                sansProgres = 0;
+            }
+            else if (++sansProgres >= 5) {
+                lambda /= 2.0;
+                sansProgres = 0;
+            }
+
+            double norme = 0.0;
+            for (int v = 0; v < n; ++v) norme += double(degre[v] - 2) * (degre[v] - 2);
+            if (norme == 0.0) break; // le 1-arbre est une tournée : la borne est atteinte
+            const double pas = lambda * std::max(majorant - valeur, 1e-9 * std::abs(majorant)) / norme;
+            for (int v = 0; v < n; ++v) pi[v] += pas * (degre[v] - 2);
+        }
+        return meilleure;
+    }
+
+    double borneInferieureTournee(double majorant, int iterations, unsigned int nbThreads = 1) const {
+        return donnees.avecEnergie([&](const auto& E) { return borneInferieureTournee(E, majorant, iterations, nbThreads); });
+    }
+
+    // Borne de l'instance pour les écarts des réplications, majorant tiré d'une première tournée
+    void calculerBorneTournee(unsigned int nbThreads = 1) {
+        borneTournee = 0.0;
+        if (parametres.iterationsBorne <= 0) return;
+        AlgorithmesGloutonsRandomises algo(donnees, 0);
+        algo.parametres = parametres;
+        algo.parametres.tempsLK = 0.0;
+        const double majorant = algo.calculerResultats({}, algo.resoudreTournee()).second;
+        borneTournee = borneInferieureTournee(majorant, parametres.iterationsBorne, nbThreads);
+    }
+
+    static double ecartBorne(double energie, double borne) {
+        return (borne > 0.0 && energie > 0.0) ? (energie - borne) / energie : 0.0;
+    }
+
+    // Listes de voisins de l'instance, ou calculées dans listesLocales si les villes ont été remplies à la main
+    template <typename Energie>
+    const ListesVoisins& listesVoisins(const Energie& E, ListesVoisins& listesLocales) const {
+        if (donnees.voisins.taille() == E.taille()) return donnees.voisins;
+        construireListesVoisins(E, donnees.nbVoisins, 1, listesLocales);
+        return listesLocales;
+    }
+
+    // 2-opt en première amélioration, restreint aux listes de voisins : pour une ville a et son
+    // successeur (ou prédécesseur) b, seules les villes c avec E(a, c) < E(a, b) sont essayées.
+    // Tournée en tableau avec positions, delta en O(1), le plus court des deux côtés est inversé.
+    // Bits "don't look" : seules les villes de la file (extrémités d'arêtes modifiées) sont réexaminées.
+    // La tournée est ensuite tournée pour recommencer en 0.
+    template <typename Energie>
+    double ameliorerTournee2Opt(const Energie& E, std::vector<int>& tournee) {
+        const int n = static_cast<int>(tournee.size());
+        if (n < 4) return 0.0;
+        ListesVoisins listesLocales;
+        const ListesVoisins& listes = listesVoisins(E, listesLocales);
+        TourneeTableau T(tournee);
+        FileVillesActives file(tournee);
+
+        double gainTotal = 0.0;
+        for (int a; file.extraire(a); ) {
+            bool ameliore = false;
+            for (int sens = 0; sens < 2 && !ameliore; ++sens) {
+                const int b = (sens == 0) ? T.suivante(a) : T.precedente(a);
+                const double dab = E(a, b);
+                const int* voisins = listes.de(a);
+                for (int r = 0; r < listes.k; ++r) {
+                    const int c = voisins[r];
+                    const double dac = E(a, c);
+                    if (dac >= dab) break;
+                    const int d = (sens == 0) ? T.suivante(c) : T.precedente(c);
+                    if (c == b || d == a) continue;
+                    const double delta = dac + E(b, d) - dab - E(c, d);
+                    if (delta >= -1e-9) continue;
+
+                    // sens 0 : a b ... c d -> a c ... b d ; sens 1 : d c ... b a -> d b ... c a
+                    if (sens == 0) T.inverser(T.position(b), T.position(c));
+                    else T.inverser(T.position(c), T.position(b));
+                    gainTotal -= delta;
+                    for (int v : { a, b, c, d }) file.activer(v);
+                    ameliore = true;
+                    break;
+                }
+            }
+        }
+
+        T.recommencerEn0();
+        return gainTotal;
+    }
+
+    // Or-opt en première amélioration : un segment de 1 à 3 villes est déplacé entre deux villes
+    // consécutives c -> d, dans son sens de parcours, donc delta exact sur matrice asymétrique :
+    //   retrait  E(p, premiere) + E(derniere, q) - E(p, q)
+    //   insertion E(c, premiere) + E(derniere, d) - E(c, d)
+    // Les points d'insertion viennent des listes de voisins (d voisin de la dernière ville, ou
+    // c voisin de la première). Le déplacement décale le plus court des deux arcs de la tournée.
+    template <typename Energie>
+    double ameliorerTourneeOrOpt(const Energie& E, std::vector<int>& tournee) {
+        const int n = static_cast<int>(tournee.size());
+        if (n < 5) return 0.0;
+        ListesVoisins listesLocales;
+        const ListesVoisins& listes = listesVoisins(E, listesLocales);
+        TourneeTableau T(tournee);
+        FileVillesActives file(tournee);
+
+        std::vector<int> candidats;
+        double gainTotal = 0.0;
+        for (int premiere; file.extraire(premiere); ) {
+            bool ameliore = false;
+            int derniere = premiere;
+            for (int longueur = 1; longueur <= 3 && !ameliore; ++longueur) {
+                if (longueur > 1) derniere = T.suivante(derniere);
+                const int p = T.precedente(premiere);
+                const int q = T.suivante(derniere);
+                if (q == p || derniere == p) break;
+                const double gainRetrait = E(p, premiere) + E(derniere, q) - E(p, q);
+                if (gainRetrait <= 1e-9) continue;
+
+                // Points d'insertion c -> d hors du segment, c != p
+                const int posPremiere = T.position(premiere);
+                auto dansSegment = [&](int v) { return (T.position(v) - posPremiere + n) % n < longueur; };
+                candidats.clear();
+                const int* voisinsDerniere = listes.de(derniere);
+                const int* voisinsPremiere = listes.de(premiere);
+                for (int r = 0; r < listes.k; ++r) {
+                    candidats.push_back(T.precedente(voisinsDerniere[r]));
+                    candidats.push_back(voisinsPremiere[r]);
+                }
+                for (int c : candidats) {
+                    if (c == p || dansSegment(c)) continue;
+                    const int d = T.suivante(c);
+                    const double delta = E(c, premiere) + E(derniere, d) - E(c, d) - gainRetrait;
+                    if (delta >= -1e-9) continue;
+
+                    // Arc [premiere .. c] tourné de longueur vers la gauche : ... c premiere .. derniere d
+                    // ou arc [d .. derniere] tourné vers la droite : c premiere .. derniere d ...
+                    const int longueurAvant = (T.position(c) - posPremiere + n) % n + 1;
+                    const int longueurArriere = (posPremiere + longueur - 1 - T.position(d) + n) % n + 1;
+                    if (longueurAvant <= longueurArriere) T.tournerArc(posPremiere, longueurAvant, longueur);
+                    else T.tournerArc(T.position(d), longueurArriere, longueurArriere - longueur);
+                    gainTotal -= delta;
+                    for (int v : { p, q, c, d, premiere, derniere }) file.activer(v);
+                    ameliore = true;
+                    break;
+                }
+            }
+        }
+
+        T.recommencerEn0();
+        return gainTotal;
+    }
+
+    // Lin-Kernighan itéré pendant limiteSecondes : OptimiseurLK sur matrice symétrique, sinon
+    // Or-opt entre les perturbations (le double pont ne retourne aucun segment). Renvoie le gain.
+    double optimiserTourneeLK(std::vector<int>& tournee, double limiteSecondes) {
+        return donnees.avecEnergie([&](const auto& E) { return optimiserTourneeLK(E, tournee, limiteSecondes); });
+    }
+
+    template <typename Energie>
+    double optimiserTourneeLK(const Energie& E, std::vector<int>& tournee, double limiteSecondes) {
+        if (tournee.size() < 8) return ameliorerTournee(E, tournee);
+        const auto debut = std::chrono::steady_clock::now();
+        auto tempsEcoule = [&]() {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - debut).count() >= limiteSecondes;
+        };
+
+        if (donnees.matriceSymetrique) {
+            ListesVoisins listesLocales;
+            OptimiseurLK<Energie> lk(E, listesVoisins(E, listesLocales), tournee);
+            const double gain = lk.optimiser(gen, tempsEcoule);
+            TourneeTableau(tournee).recommencerEn0();
+            return gain;
+        }
+
+        double gainTotal = ameliorerTourneeOrOpt(E, tournee);
+        std::vector<int> meilleure = tournee;
+        double ecart = 0.0; // énergie courante - énergie de meilleure
+        while (!tempsEcoule()) {
+            TourneeTableau T(tournee);
+            ecart += perturberDoublePont(E, T, gen, nullptr);
+            ecart -= ameliorerTourneeOrOpt(E, tournee);
+            if (ecart < -1e-9) {
+                gainTotal -= ecart;
+                ecart = 0.0;
+                meilleure = tournee;
+            }
+            else {
+                tournee = meilleure;
+                ecart = 0.0;
             }
         }
-        return solution;
+        tournee = std::move(meilleure);
+        return gainTotal;
     }
 
     std::vector<int> resoudreTourneeRandomisee(int M = 2) {
+        return donnees.avecEnergie([&](const auto& E) { return resoudreTourneeRandomisee(E, M); });
+    }
+
+    // A chaque étape, les M villes non visitées les plus proches sont sélectionnées en un seul passage
+    // (SelectionPlusProches), sans tri complet ni allocation. Les listes de voisins de l'instance sont
+    // essayées d'abord : dès qu'elles contiennent min(M, villes restantes) villes non visitées, ce sont
+    // exactement les plus proches. Sinon seules les villes restantes sont parcourues (VillesRestantes),
+    // avec leurs énergies rassemblées par energiesVers : une étape coûte O(villes restantes), pas O(N).
+    // Le tirage reste uniforme parmi ces M villes ; à distance égale, la ville de plus petit indice
+    // passe devant, quel que soit l'ordre du parcours.
+    template <typename Energie>
+    std::vector<int> resoudreTourneeRandomisee(const Energie& E, int M) {
         int nbVilles = donnees.villes.size();
-        std::vector<bool> visite(nbVilles, false);
+        const ListesVoisins& listes = donnees.voisins;
+        const bool avecVoisins = listes.taille() == static_cast<size_t>(nbVilles);
+        VillesRestantes restantes(nbVilles);
+        std::vector<double> energies(nbVilles);
+        SelectionPlusProches selection;
         std::vector<int> tournee;
+        tournee.reserve(nbVilles);
         int villeActuelle = 0;
         tournee.push_back(villeActuelle);
-        visite[villeActuelle] = true;
+        if (nbVilles > 0) restantes.retirer(villeActuelle);
         std::uniform_int_distribution<> dist(0, M - 1);
 
         while (tournee.size() < nbVilles) {
-            std::vector<std::pair<int, double>> distances;
-            for (int v = 0; v < nbVilles; ++v) {
-                if (!visite[v]) {
-                    distances.emplace_back(v, donnees.matriceEnergie[villeActuelle][v]);
+            const int attendus = std::min(M, restantes.taille());
+            selection.reinitialiser(M);
+            if (avecVoisins) {
+                const int* voisins = listes.de(villeActuelle);
+                for (int r = 0; r < listes.k && selection.taille() < attendus; ++r) {
+                    if (restantes.contient(voisins[r])) selection.proposer(voisins[r], E(villeActuelle, voisins[r]));
                 }
             }
-            std::sort(distances.begin(), distances.end(), [](const auto& a, const auto& b) {
-                return a.second < b.second;
-                });
-            int nbCandidats = std::min(M, static_cast<int>(distances.size()));
+            if (selection.taille() < attendus) {
+                selection.reinitialiser(M);
+                const int nb = restantes.taille();
+                E.energiesVers(villeActuelle, restantes.donnees(), nb, energies.data());
+                for (int k = 0; k < nb; ++k) selection.proposer(restantes.ville(k), energies[k]);
+            }
+            int nbCandidats = selection.taille();
             if (nbCandidats > 0) {
                 int choix = dist(gen) % nbCandidats;
-                int prochaineVille = distances[choix].first;
+                int prochaineVille = selection.ville(choix);
                 tournee.push_back(prochaineVille);
-                visite[prochaineVille] = true;
+                restantes.retirer(prochaineVille);
                 villeActuelle = prochaineVille;
             }
         }
@@ -238,29 +3241,63 @@ public:
         double benefice = 0.0;
         for (const auto& p : sac) benefice += p.valeur;
 
+        double energie = donnees.avecEnergie([&](const auto& E) { return energieTournee(E, tournee); });
+        return std::make_pair(benefice, energie);
+    }
+
+    template <typename Energie>
+    static double energieTournee(const Energie& E, const std::vector<int>& tournee) {
         double energie = 0.0;
-        for (size_t i = 0; i < tournee.size() - 1; ++i) {
-            energie += donnees.matriceEnergie[tournee[i]][tournee[i + 1]];
+        for (size_t i = 0; i + 1 < tournee.size(); ++i) {
+            energie += E(tournee[i], tournee[i + 1]);
         }
         if (!tournee.empty()) {
-            energie += donnees.matriceEnergie[tournee.back()][0];
+            energie += E(tournee.back(), 0);
         }
-        return std::make_pair(benefice, energie);
+        return energie;
     }
 
 
     //Q8****
     void executerReplication(unsigned int graine, const std::string& fichierProduits, const std::string& fichierVilles, std::ofstream& resultatsFichier) {
-        GestionDonnees donneesLocale;
-        if (!donneesLocale.lireProduits(fichierProduits) || !donneesLocale.lireVilles(fichierVilles)) {
+        std::shared_ptr<const GestionDonnees> donneesLocale = CacheInstances::global().obtenir(fichierProduits, fichierVilles);
+        if (!donneesLocale) {
             std::lock_guard<std::mutex> lock(mtx);
             std::cerr << "Erreur lors de la lecture des fichiers pour la graine " << graine << std::endl;
             return;
         }
 
-        AlgorithmesGloutonsRandomises algo(donneesLocale, graine);
-        auto sac = algo.resoudreSacADosRandomise();
-        auto tournee = algo.resoudreTourneeRandomisee();
+        executerReplication(graine, *donneesLocale, resultatsFichier);
+    }
+
+    // Réplication isolée : ses meilleures solutions sont fusionnées immédiatement
+    void executerReplication(unsigned int graine, const GestionDonnees& instance, std::ostream& resultatsFichier) {
+        MeilleuresSolutions locales;
+        executerReplication(graine, instance, resultatsFichier, locales);
+        fusionnerMeilleuresSolutions(locales);
+    }
+
+    void executerReplication(unsigned int graine, const GestionDonnees& instance, std::ostream& resultatsFichier, MeilleuresSolutions& locales) {
+        const EnregistrementResultat resultat = resoudreReplication(graine, instance, locales);
+        char ligne[TAILLE_LIGNE_CSV];
+        const std::string texte(ligne, formaterResultatCsv(resultat, ligne, ligne + sizeof(ligne)));
+        std::lock_guard<std::mutex> lock(mtx);
+        resultatsFichier << texte;
+    }
+
+    // Réplication sur une instance déjà chargée ; peut être appelée depuis plusieurs threads,
+    // chacun avec ses propres meilleures solutions locales
+    EnregistrementResultat executerReplication(unsigned int graine, const GestionDonnees& instance, PuitsResultats& puits, MeilleuresSolutions& locales) {
+        const EnregistrementResultat resultat = resoudreReplication(graine, instance, locales);
+        puits.ajouter(resultat);
+        return resultat;
+    }
+
+    EnregistrementResultat resoudreReplication(unsigned int graine, const GestionDonnees& instance, MeilleuresSolutions& locales) {
+        AlgorithmesGloutonsRandomises algo(instance, graine);
+        algo.parametres = parametres;
+        auto sac = algo.resoudreSacADos();
+        auto tournee = algo.resoudreTournee();
         auto resultats = algo.calculerResultats(sac, tournee);
         double benefice = resultats.first;
         double energie = resultats.second;
@@ -268,39 +3305,49 @@ public:
         double scoreP1 = benefice;
         double scoreP2 = benefice - energie;
 
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            // Mettre  jour la meilleure solution pour P1
-            if (scoreP1 > meilleurScoreP1) {
-                meilleurScoreP1 = scoreP1;
-                meilleureSolutionP1 = sac;
-            }
+        // Mettre à jour la meilleure solution pour P1 (copie seulement si le meilleur global est battu)
+        if (scoreP1 > locales.scoreP1 && majMaximumAtomique(scoreGlobalP1, scoreP1)) {
+            locales.scoreP1 = scoreP1;
+            locales.solutionP1 = std::move(sac);
+        }
 
-            // Mettre  jour la meilleure solution pour P2
-            if (scoreP2 > meilleurScoreP2) {
-                meilleurScoreP2 = scoreP2;
-                meilleureSolutionP2 = tournee;
-            }
+        // Mettre à jour la meilleure solution pour P2
+        if (scoreP2 > locales.scoreP2 && majMaximumAtomique(scoreGlobalP2, scoreP2)) {
+            locales.scoreP2 = scoreP2;
+            locales.solutionP2 = std::move(tournee);
+        }
+
+        return { graine, 0, benefice, energie, benefice - energie, borneTournee, ecartBorne(energie, borneTournee) };
+    }
 
-            resultatsFichier << graine << "," << benefice << "," << energie << "," << (benefice - energie) << std::endl;
+    // Réduction finale des meilleures solutions d'un thread
+    void fusionnerMeilleuresSolutions(MeilleuresSolutions& locales) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (locales.scoreP1 > meilleurScoreP1) {
+            meilleurScoreP1 = locales.scoreP1;
+            meilleureSolutionP1 = std::move(locales.solutionP1);
+        }
+        if (locales.scoreP2 > meilleurScoreP2) {
+            meilleurScoreP2 = locales.scoreP2;
+            meilleureSolutionP2 = std::move(locales.solutionP2);
         }
     }
 
 
     //Q4*****
     void afficherResultats() {
-        // Rsolution des deux problmes
+        // Résolution des deux problèmes
         auto sac = resoudreSacADosRandomise();
         auto tournee = resoudreTourneeRandomisee();
 
-        // Calcul des rsultats
+        // Calcul des résultats
         auto resultats = calculerResultats(sac, tournee);
         double benefice = resultats.first;
         double energie = resultats.second;
 
-        // Affichage des rsultats pour P1 (sac  dos)
-        std::cout << "=== Rsultats pour le problme P1 (Sac  dos) ===" << std::endl;
-        std::cout << "Produits slectionns : " << std::endl;
+        // Affichage des résultats pour P1 (sac à dos)
+        std::cout << "=== Résultats pour le problème P1 (Sac à dos) ===" << std::endl;
+        std::cout << "Produits sélectionnés : " << std::endl;
         for (const auto& produit : sac) {
             std::cout << "  - ID: " << produit.id
                 << ", Poids: " << produit.poids
@@ -308,19 +3355,19 @@ public:
                 << ", Ratio: " << produit.ratio << std::endl;
         }
 
-        // Affichage des rsultats pour P2 (tourne)
-        std::cout << "=== Rsultats pour le problme P2 (Tourne) ===" << std::endl;
-        std::cout << "Villes visites dans l'ordre : " << std::endl;
+        // Affichage des résultats pour P2 (tournée)
+        std::cout << "=== Résultats pour le problème P2 (Tournée) ===" << std::endl;
+        std::cout << "Villes visitées dans l'ordre : " << std::endl;
         for (int villeId : tournee) {
             std::cout << "  - Ville ID: " << villeId
                 << " (" << donnees.villes[villeId].nom << ")" << std::endl;
         }
 
-        // Affichage des bnfices et de l'nergie consomme
-        std::cout << "=== Rsultats globaux ===" << std::endl;
-        std::cout << "Bnfice total : " << benefice << std::endl;
-        std::cout << "nergie totale consomme : " << energie << std::endl;
-        std::cout << "Score (Bnfice - nergie) : " << (benefice - energie) << std::endl;
+        // Affichage des bénéfices et de l'énergie consommée
+        std::cout << "=== Résultats globaux ===" << std::endl;
+        std::cout << "Bénéfice total : " << benefice << std::endl;
+        std::cout << "Énergie totale consommée : " << energie << std::endl;
+        std::cout << "Score (Bénéfice - Énergie) : " << (benefice - energie) << std::endl;
     }
 
     // Accesseurs pour les meilleures solutions
@@ -332,6 +3379,27 @@ public:
 
 
 
+// Réplications dans le processus : l'instance est chargée une fois et les graines 1..nbReplications
+// sont réparties sur nbThreads threads (mêmes colonnes CSV que les scripts)
+// Renvoie le nombre de réplications effectuées : avec parametres.ecartArret > 0, les réplications
+// pas encore commencées sont abandonnées dès qu'une tournée est à moins de cet écart de la borne
+int executerReplications(AlgorithmesGloutonsRandomises& algo, const GestionDonnees& instance, int nbReplications, unsigned int nbThreads, PuitsResultats& puits) {
+    const size_t nbTaches = static_cast<size_t>(nbReplications);
+    const double seuil = algo.parametres.ecartArret;
+    const bool arretPossible = seuil > 0.0 && algo.borneTournee > 0.0;
+    std::vector<MeilleuresSolutions> locales(nbThreadsEffectif(nbTaches, nbThreads));
+    std::atomic<bool> arret{ false };
+    std::atomic<int> effectuees{ 0 };
+    executerEnParalleleParThread(nbTaches, nbThreads, [&](size_t i, unsigned int t) {
+        if (arret.load(std::memory_order_relaxed)) return;
+        const EnregistrementResultat r = algo.executerReplication(static_cast<unsigned int>(i + 1), instance, puits, locales[t]);
+        effectuees.fetch_add(1, std::memory_order_relaxed);
+        if (arretPossible && r.ecart <= seuil) arret.store(true, std::memory_order_relaxed);
+        });
+    for (auto& l : locales) algo.fusionnerMeilleuresSolutions(l);
+    return effectuees.load();
+}
+
 //Q8***
 void genererScriptLinux(int nbReplications, const std::string& nomProgramme, const std::string& fichierProduits, const std::string& fichierVilles) {
     std::ofstream script("replications.sh");
@@ -387,12 +3455,13 @@ void testLectureFichiers() {
     genererFichierVilles("test_villes.txt");
 
     GestionDonnees donnees;
-    assert(donnees.lireProduits("test_produits.txt"));
-    assert(donnees.lireVilles("test_villes.txt"));
+    const bool chargementDonnees = donnees.lireProduits("test_produits.txt") && donnees.lireVilles("test_villes.txt");
+    assert(chargementDonnees);
     assert(donnees.produits.size() == 5);
     assert(donnees.villes.size() == 4);
-    assert(donnees.matriceEnergie.size() == 4);
-    assert(donnees.matriceEnergie[0].size() == 4);
+    assert(donnees.matriceEnergie.taille() == 4);
+    assert(donnees.energie()(2, 3) == 8.0);
+    assert(reinterpret_cast<uintptr_t>(donnees.energie().donnees) % ALIGNEMENT_MATRICE == 0);
 }
 
 void testAlgorithmesGloutonsRandomises() {
@@ -414,6 +3483,138 @@ void testAlgorithmesGloutonsRandomises() {
     assert(energie > 0);
 }
 
+void testSacADosExact() {
+    genererFichierProduits("test_produits.txt");
+
+    GestionDonnees donnees;
+    const bool chargementDonnees = donnees.lireProduits("test_produits.txt");
+    assert(chargementDonnees);
+    AlgorithmesGloutonsRandomises algo(donnees, 42);
+    auto sac = algo.resoudreSacADosExact();
+    double benefice = 0.0, poids = 0.0;
+    for (const auto& p : sac) {
+        benefice += p.valeur;
+        poids += p.poids;
+    }
+    assert(benefice == 12.0 && poids <= donnees.capaciteMax);
+
+    // Comparaison avec l'énumération complète sur une petite instance aléatoire
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<> dist(1, 30);
+    donnees.produits.clear();
+    for (int i = 0; i < 14; ++i) {
+        Produit p{ i + 1, static_cast<double>(dist(gen)), static_cast<double>(dist(gen)), 0.0 };
+        p.ratio = p.valeur / p.poids;
+        donnees.produits.push_back(p);
+    }
+    donnees.capaciteMax = 100.0;
+    donnees.calculerOrdreRatio();
+
+    // Optimum par énumération des 2^n sous-ensembles
+    auto optimumEnumere = [&]() {
+        const int n = static_cast<int>(donnees.produits.size());
+        double meilleur = 0.0;
+        for (int masque = 0; masque < (1 << n); ++masque) {
+            double v = 0.0, w = 0.0;
+            for (int i = 0; i < n; ++i) {
+                if (masque & (1 << i)) {
+                    v += donnees.produits[i].valeur;
+                    w += donnees.produits[i].poids;
+                }
+            }
+            if (w <= donnees.capaciteMax) meilleur = std::max(meilleur, v);
+        }
+        return meilleur;
+    };
+    double optimum = optimumEnumere();
+    benefice = 0.0;
+    for (const auto& p : algo.resoudreSacADosExact()) benefice += p.valeur;
+    assert(benefice == optimum);
+
+    // Branch and bound : mêmes produits avec des poids réels
+    for (auto& p : donnees.produits) {
+        p.poids += 0.37;
+        p.ratio = p.valeur / p.poids;
+    }
+    donnees.calculerOrdreRatio();
+    optimum = optimumEnumere();
+    ResultatSacExact bb = algo.resoudreSacADosBranchAndBound();
+    assert(bb.optimal && bb.ecart == 0.0 && std::abs(bb.valeur - optimum) < 1e-9);
+    ResultatSacExact noyau = algo.resoudreSacADosNoyau(10000000, 1.0, 2);
+    assert(noyau.optimal && std::abs(noyau.valeur - optimum) < 1e-9);
+
+    // Noyau : objet critique en dernière position (tous les autres tiennent), puis tout tient
+    donnees.produits = { { 1, 2.0, 6.0, 3.0 }, { 2, 3.0, 6.0, 2.0 }, { 3, 9.0, 2.0, 2.0 / 9.0 } };
+    donnees.capaciteMax = 10.0;
+    donnees.calculerOrdreRatio();
+    noyau = algo.resoudreSacADosNoyau();
+    assert(noyau.optimal && noyau.valeur == 12.0);
+    donnees.capaciteMax = 14.0;
+    noyau = algo.resoudreSacADosNoyau();
+    assert(noyau.optimal && noyau.valeur == 14.0 && noyau.indices.size() == 3);
+}
+
+void testRechercheLocaleSac() {
+    genererFichierProduits("test_produits.txt");
+
+    GestionDonnees donnees;
+    const bool chargementDonnees = donnees.lireProduits("test_produits.txt");
+    assert(chargementDonnees);
+    AlgorithmesGloutonsRandomises algo(donnees, 42);
+    // Produits 1, 2 et 5 (poids 24, valeur 10) : aucun ajout possible, l'échange 2 -> 4 donne l'optimum 12
+    std::vector<int> indices = { 0, 1, 4 };
+    double gain = algo.ameliorerSacADos(indices);
+    double benefice = 0.0, poids = 0.0;
+    for (int i : indices) {
+        benefice += donnees.produits[i].valeur;
+        poids += donnees.produits[i].poids;
+    }
+    assert(poids <= donnees.capaciteMax);
+    assert(benefice == 10.0 + gain && benefice == 12.0);
+}
+
+void testGrasp() {
+    genererFichierProduits("test_produits.txt");
+    genererFichierVilles("test_villes.txt");
+
+    GestionDonnees donnees;
+    const bool chargementDonnees = donnees.lireProduits("test_produits.txt") && donnees.lireVilles("test_villes.txt");
+    assert(chargementDonnees);
+
+    for (ListeRestreinte liste : { ListeRestreinte::Cardinalite, ListeRestreinte::Valeur }) {
+        for (double alpha : { 0.0, 0.5, 1.0 }) {
+            AlgorithmesGloutonsRandomises algo(donnees, 7);
+            algo.parametres.villesMaxHeldKarp = 0;
+            algo.parametres.listeRestreinte = liste;
+            algo.parametres.alpha = alpha;
+            algo.parametres.rechercheLocaleSac = false;
+            double poids = 0.0;
+            for (const auto& p : algo.resoudreSacADos()) poids += p.poids;
+            assert(poids <= donnees.capaciteMax);
+
+            auto tournee = algo.resoudreTournee();
+            assert(tournee.size() == 4 && tournee[0] == 0);
+            assert(std::is_permutation(tournee.begin(), tournee.end(), std::vector<int>{ 0, 1, 2, 3 }.begin()));
+        }
+    }
+
+    // alpha = 0 : plus proche voisin, Lille -> Arros -> Amiens -> Loos -> Lille
+    AlgorithmesGloutonsRandomises algo(donnees, 7);
+    algo.parametres.villesMaxHeldKarp = 0;
+    algo.parametres.rechercheLocaleTournee = false;
+    algo.parametres.listeRestreinte = ListeRestreinte::Valeur;
+    algo.parametres.alpha = 0.0;
+    const double energie = algo.calculerResultats({}, algo.resoudreTournee()).second;
+    assert(energie == 50.0);
+
+    // GRASP réactif sur plusieurs constructions : l'optimum de P1 (12) est atteint
+    algo.parametres.alphaReactif = true;
+    algo.parametres.iterationsGrasp = 30;
+    double benefice = 0.0;
+    for (const auto& p : algo.resoudreSacADos()) benefice += p.valeur;
+    assert(benefice == 12.0);
+}
+
 void testReplications() {
     genererFichierProduits("test_produits.txt");
     genererFichierVilles("test_villes.txt");
@@ -435,6 +3636,405 @@ void testReplications() {
 }
 
 
+void genererFichierVillesCoordonnees(const std::string& fichier) {
+    std::ofstream fout(fichier);
+    fout << "4 xy\n";
+    fout << "Lille;0.0;0.0\n";
+    fout << "Arros;3.0;4.0\n";
+    fout << "Amiens;6.0;0.0\n";
+    fout << "Loos;3.0;-4.0\n";
+    fout.close();
+}
+
+// Nuage de n villes tirées uniformément dans [0, cote]², en coordonnées, avec leurs listes de voisins
+void genererNuageVilles(GestionDonnees& donnees, int n, unsigned int graine, double cote) {
+    std::mt19937 gen(graine);
+    std::uniform_real_distribution<> dist(0.0, cote);
+    for (int i = 0; i < n; ++i) {
+        donnees.coordonnees.x.push_back(dist(gen));
+        donnees.coordonnees.y.push_back(dist(gen));
+        donnees.villes.push_back({ i, "" });
+    }
+    donnees.matriceSymetrique = true;
+    donnees.calculerVoisins();
+}
+
+// Tournée améliorée depuis une énergie avant : gain exact, départ en 0 et permutation de toutes
+// les villes. Renvoie l'énergie après amélioration.
+double verifierTournee(AlgorithmesGloutonsRandomises& algo, const std::vector<int>& tournee, double avant, double gain) {
+    const double apres = algo.calculerResultats({}, tournee).second;
+    assert(gain > 0 && std::abs(avant - gain - apres) < 1e-6 * avant);
+    assert(tournee[0] == 0);
+    std::vector<int> triee = tournee;
+    std::sort(triee.begin(), triee.end());
+    for (size_t i = 0; i < triee.size(); ++i) assert(triee[i] == static_cast<int>(i));
+    return apres;
+}
+
+void testVillesCoordonnees() {
+    genererFichierProduits("test_produits.txt");
+    genererFichierVillesCoordonnees("test_villes_xy.txt");
+
+    GestionDonnees donnees;
+    const bool chargementDonnees = donnees.lireProduits("test_produits.txt") && donnees.lireVilles("test_villes_xy.txt");
+    assert(chargementDonnees);
+    assert(donnees.stockageCoordonnees() && donnees.matriceEnergie.taille() == 0);
+    assert(donnees.villes[1].nom == "Arros");
+
+    const VueCoordonnees C = donnees.coordonnees.vue();
+    assert(C(0, 1) == 5.0 && C(1, 0) == 5.0 && C(0, 2) == 6.0 && C(1, 3) == 8.0);
+    std::vector<double> ligne(4);
+    const double* energies = C.ligneEnergies(1, ligne.data());
+    for (int j = 0; j < 4; ++j) assert(std::abs(energies[j] - C(1, j)) < 1e-12);
+
+    AlgorithmesGloutonsRandomises algo(donnees, 42);
+    auto tournee = algo.resoudreTourneeRandomisee();
+    assert(tournee.size() == 4 && tournee[0] == 0);
+    assert(std::abs(algo.calculerResultats({}, { 0, 1, 2, 3 }).second - 20.0) < 1e-12);
+}
+
+void testVillesRestantes() {
+    VillesRestantes restantes(10);
+    for (int v : { 0, 9, 4 }) restantes.retirer(v);
+    assert(restantes.taille() == 7 && !restantes.contient(4) && restantes.contient(5));
+    std::vector<int> vues(restantes.donnees(), restantes.donnees() + restantes.taille());
+    std::sort(vues.begin(), vues.end());
+    assert(vues == std::vector<int>({ 1, 2, 3, 5, 6, 7, 8 }));
+
+    // energiesVers donne E(i, j) pour chaque vue (dense, triangulaire, coordonnées)
+    genererFichierVilles("test_villes.txt");
+    genererFichierVillesCoordonnees("test_villes_xy.txt");
+    for (ModeStockage mode : { ModeStockage::Dense, ModeStockage::Triangulaire }) {
+        GestionDonnees donnees;
+        donnees.modeStockage = mode;
+        const bool chargementDonnees = donnees.lireVilles("test_villes.txt");
+        assert(chargementDonnees);
+        GestionDonnees coordonnees;
+        const bool chargementCoordonnees = coordonnees.lireVilles("test_villes_xy.txt");
+        assert(chargementCoordonnees);
+        for (const GestionDonnees* d : { &donnees, &coordonnees }) {
+            d->avecEnergie([&](const auto& E) {
+                const int villes[] = { 3, 1, 2, 0, 3 };
+                double energies[5];
+                E.energiesVers(2, villes, 5, energies);
+                for (int k = 0; k < 5; ++k) assert(energies[k] == E(2, villes[k]));
+                });
+        }
+    }
+}
+
+void testListesVoisins() {
+    // Même nuage de points en coordonnées (grille) et en matrice dense (parcours des lignes)
+    const int n = 300;
+    GestionDonnees coordonnees, dense;
+    genererNuageVilles(coordonnees, n, 3, 100.0);
+
+    const VueCoordonnees C = coordonnees.coordonnees.vue();
+    dense.villes = coordonnees.villes;
+    dense.matriceEnergie.redimensionner(n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) dense.matriceEnergie.ligne(i)[j] = C(i, j);
+    }
+    dense.calculerVoisins();
+    assert(coordonnees.voisins.k == 10 && coordonnees.voisins.taille() == static_cast<size_t>(n));
+    assert(coordonnees.voisins.voisins == dense.voisins.voisins);
+
+    // Les listes accélèrent la construction sans changer les tournées tirées
+    for (int M : { 1, 3, 12 }) {
+        AlgorithmesGloutonsRandomises avecListes(dense, 5);
+        const auto tournee = avecListes.resoudreTourneeRandomisee(M);
+        ListesVoisins listes = std::move(dense.voisins);
+        dense.voisins.liberer();
+        AlgorithmesGloutonsRandomises sansListes(dense, 5);
+        assert(sansListes.resoudreTourneeRandomisee(M) == tournee);
+        dense.voisins = std::move(listes);
+    }
+}
+
+void test2Opt() {
+    GestionDonnees donnees;
+    genererNuageVilles(donnees, 500, 11, 1000.0);
+
+    AlgorithmesGloutonsRandomises algo(donnees, 1);
+    auto tournee = algo.resoudreTourneeRandomisee(3);
+    const double avant = algo.calculerResultats({}, tournee).second;
+    const double gain = algo.ameliorerTournee(tournee);
+    verifierTournee(algo, tournee, avant, gain);
+
+    // Optimum local : un second passage ne trouve plus rien
+    assert(algo.ameliorerTournee(tournee) == 0.0);
+}
+
+void testOrOptAsymetrique() {
+    // Matrice asymétrique (montées et descentes) : le 2-opt n'est pas appliqué, l'Or-opt l'est
+    const int n = 80;
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<> dist(1.0, 100.0);
+    GestionDonnees donnees;
+    donnees.matriceEnergie.redimensionner(n);
+    for (int i = 0; i < n; ++i) {
+        donnees.villes.push_back({ i, "" });
+        for (int j = 0; j < n; ++j) donnees.matriceEnergie.ligne(i)[j] = (i == j) ? 0.0 : dist(gen);
+    }
+    donnees.matriceSymetrique = false;
+    donnees.calculerVoisins();
+
+    AlgorithmesGloutonsRandomises algo(donnees, 2);
+    auto tournee = algo.resoudreTourneeRandomisee(4);
+    const double avant = algo.calculerResultats({}, tournee).second;
+    const double gain = algo.ameliorerTournee(tournee);
+    verifierTournee(algo, tournee, avant, gain);
+}
+
+void testLinKernighan() {
+    GestionDonnees donnees;
+    genererNuageVilles(donnees, 400, 13, 1000.0);
+
+    AlgorithmesGloutonsRandomises algo(donnees, 3);
+    auto tournee = algo.resoudreTourneeRandomisee();
+    algo.ameliorerTournee(tournee);
+    const double avant = algo.calculerResultats({}, tournee).second;
+    const double gain = algo.optimiserTourneeLK(tournee, 0.05);
+    const double apres = verifierTournee(algo, tournee, avant, gain);
+
+    // Matrice asymétrique : perturbations et Or-opt seulement, le gain reste exact
+    donnees.matriceSymetrique = false;
+    const double gainAsymetrique = algo.optimiserTourneeLK(tournee, 0.01);
+    assert(std::abs(apres - gainAsymetrique - algo.calculerResultats({}, tournee).second) < 1e-6 * apres);
+}
+
+void testHeldKarp() {
+    genererFichierVilles("test_villes.txt");
+    GestionDonnees donnees;
+    const bool chargementDonnees = donnees.lireVilles("test_villes.txt");
+    assert(chargementDonnees);
+    AlgorithmesGloutonsRandomises algo(donnees, 1);
+    algo.parametres.villesMaxHeldKarp = VILLES_MAX_HELD_KARP;
+    const auto optimale = algo.resoudreTournee();
+    assert(optimale == std::vector<int>({ 0, 1, 2, 3 }) || optimale == std::vector<int>({ 0, 3, 2, 1 }));
+
+    // Matrice asymétrique de 9 villes : comparaison avec l'énumération des 8! tournées
+    const int n = 9;
+    std::mt19937 gen(17);
+    std::uniform_real_distribution<> dist(1.0, 100.0);
+    GestionDonnees asymetrique;
+    asymetrique.matriceEnergie.redimensionner(n);
+    for (int i = 0; i < n; ++i) {
+        asymetrique.villes.push_back({ i, "" });
+        for (int j = 0; j < n; ++j) asymetrique.matriceEnergie.ligne(i)[j] = (i == j) ? 0.0 : dist(gen);
+    }
+    AlgorithmesGloutonsRandomises exact(asymetrique, 1);
+    const auto tournee = exact.resoudreTourneeHeldKarp();
+    assert(tournee.size() == static_cast<size_t>(n) && tournee[0] == 0);
+    const double energie = exact.calculerResultats({}, tournee).second;
+
+    std::vector<int> permutation = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+    double meilleure = std::numeric_limits<double>::infinity();
+    do {
+        meilleure = std::min(meilleure, exact.calculerResultats({}, permutation).second);
+    } while (std::next_permutation(permutation.begin() + 1, permutation.end()));
+    assert(std::abs(energie - meilleure) < 1e-9);
+
+    // Table au-delà de la limite mémoire : resoudreTournee se rabat sur l'heuristique
+    assert(memoireHeldKarp(VILLES_MAX_HELD_KARP) > ParametresResolution().memoireMaxHeldKarp);
+    exact.parametres.villesMaxHeldKarp = VILLES_MAX_HELD_KARP;
+    exact.parametres.memoireMaxHeldKarp = memoireHeldKarp(n) - 1;
+    auto heuristique = exact.resoudreTournee();
+    assert(heuristique.size() == static_cast<size_t>(n) && heuristique[0] == 0);
+    assert(exact.calculerResultats({}, heuristique).second >= meilleure - 1e-9);
+    std::sort(heuristique.begin(), heuristique.end());
+    for (int v = 0; v < n; ++v) assert(heuristique[v] == v);
+}
+
+void testBorneTournee() {
+    // 4 villes : la borne ne dépasse pas l'optimum (50), atteint par Held-Karp
+    genererFichierVilles("test_villes.txt");
+    GestionDonnees donnees;
+    const bool chargementDonnees = donnees.lireVilles("test_villes.txt");
+    assert(chargementDonnees);
+    AlgorithmesGloutonsRandomises algo(donnees, 1);
+    const double borne = algo.borneInferieureTournee(50.0, 100);
+    assert(borne > 0.0 && borne <= 50.0 + 1e-9);
+
+    // Nuage de points : borne sous l'énergie d'une tournée optimisée, à quelques pour cent
+    GestionDonnees nuage;
+    genererNuageVilles(nuage, 200, 21, 1000.0);
+    AlgorithmesGloutonsRandomises lk(nuage, 1);
+    auto tournee = lk.resoudreTourneeRandomisee();
+    lk.optimiserTourneeLK(tournee, 0.02);
+    const double energie = lk.calculerResultats({}, tournee).second;
+    const double borneNuage = lk.borneInferieureTournee(energie, 100);
+    assert(borneNuage <= energie && AlgorithmesGloutonsRandomises::ecartBorne(energie, borneNuage) < 0.1);
+}
+
+void testPrecisionReduite() {
+    genererFichierVilles("test_villes.txt");
+
+    GestionDonnees reference;
+    const bool chargementReference = reference.lireVilles("test_villes.txt");
+    assert(chargementReference);
+
+    for (Precision precision : { Precision::Float, Precision::Quantifie16 }) {
+        for (ModeStockage mode : { ModeStockage::Dense, ModeStockage::Triangulaire }) {
+            GestionDonnees donnees;
+            donnees.precision = precision;
+            donnees.modeStockage = mode;
+            const bool chargementDonnees = donnees.lireVilles("test_villes.txt");
+            assert(chargementDonnees);
+            assert(donnees.matriceEnergie.taille() == 0 && donnees.matriceTriangulaire.taille() == 0);
+            donnees.avecEnergie([&](const auto& E) {
+                for (int i = 0; i < 4; ++i) {
+                    for (int j = 0; j < 4; ++j) assert(std::abs(E(i, j) - reference.energie()(i, j)) < 1e-3);
+                }
+                });
+        }
+    }
+}
+
+void testStockageTriangulaire() {
+    genererFichierVilles("test_villes.txt");
+
+    GestionDonnees dense;
+    const bool chargementDense = dense.lireVilles("test_villes.txt");
+    assert(chargementDense);
+    assert(dense.matriceSymetrique && !dense.stockageTriangulaire());
+
+    for (ModeStockage mode : { ModeStockage::Auto, ModeStockage::Triangulaire }) {
+        GestionDonnees triangulaire;
+        triangulaire.modeStockage = mode;
+        const bool chargementTriangulaire = triangulaire.lireVilles("test_villes.txt");
+        assert(chargementTriangulaire);
+        assert(triangulaire.stockageTriangulaire() && triangulaire.matriceEnergie.taille() == 0);
+        const VueMatriceTriangulaire<double> T = triangulaire.matriceTriangulaire.vue();
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) assert(T(i, j) == dense.energie()(i, j));
+        }
+    }
+
+    // Auto sur une matrice non symétrique : relue en stockage dense, sans perte
+    std::ofstream fout("test_villes_asym.txt");
+    fout << "3\nA\nB\nC\n0 1 2\n5 0 1\n2 1 0\n";
+    fout.close();
+    GestionDonnees asymetrique;
+    asymetrique.modeStockage = ModeStockage::Auto;
+    const bool chargementAsymetrique = asymetrique.lireVilles("test_villes_asym.txt");
+    assert(chargementAsymetrique);
+    assert(!asymetrique.matriceSymetrique && !asymetrique.stockageTriangulaire());
+    assert(asymetrique.energie()(1, 0) == 5.0 && asymetrique.energie()(0, 1) == 1.0 && asymetrique.energie()(2, 1) == 1.0);
+}
+
+void testFormatBinaire() {
+    genererFichierProduits("test_produits.txt");
+    genererFichierVilles("test_villes.txt");
+
+    GestionDonnees texte;
+    const bool chargementTexte = texte.lireProduits("test_produits.txt") && texte.lireVilles("test_villes.txt");
+    assert(chargementTexte);
+    const bool ecritureTexte = texte.ecrireProduitsBinaire("test_produits.bin") && texte.ecrireVillesBinaire("test_villes.bin");
+    assert(ecritureTexte);
+
+    GestionDonnees binaire;
+    const bool chargementBinaire = binaire.lireProduits("test_produits.bin") && binaire.lireVilles("test_villes.bin");
+    assert(chargementBinaire);
+    assert(binaire.capaciteMax == texte.capaciteMax);
+    assert(binaire.produits.size() == texte.produits.size());
+    assert(binaire.produits[3].id == 4 && binaire.produits[3].poids == 15.0);
+    assert(binaire.villes.size() == 4 && binaire.villes[2].nom == "Amiens");
+    for (int i = 0; i < 4; ++i) {
+        assert(std::equal(texte.energie().ligne(i), texte.energie().ligne(i) + 4, binaire.energie().ligne(i)));
+    }
+}
+
+
+void testPuitsResultats() {
+    std::remove("test_puits.txt");
+    {
+        PuitsResultats puits("test_puits.txt");
+        executerEnParallele(4, 4, [&](size_t t) {
+            for (uint32_t i = 0; i < 1000; ++i) puits.ajouter({ static_cast<uint32_t>(t * 1000 + i), 0, 1.5, 0.25, 1.25, 0.0, 0.0 });
+            });
+    }
+
+    std::ifstream fin("test_puits.txt");
+    std::string ligne;
+    int count = 0;
+    while (std::getline(fin, ligne)) {
+        assert(ligne.substr(ligne.find(',')) == ",1.5,0.25,1.25,0,0");
+        ++count;
+    }
+    assert(count == 4000);
+    // Ligne la plus longue : chaque double au plus court aller-retour sur 24 caractères
+    const double long24 = -1.2345678901234567e-300;
+    const EnregistrementResultat pire{ std::numeric_limits<uint32_t>::max(), 0, long24, long24, long24, long24, long24 };
+    char tampon[TAILLE_LIGNE_CSV];
+    const char* finLigne = formaterResultatCsv(pire, tampon, tampon + sizeof(tampon));
+    assert(finLigne - tampon == 10 + 5 * 24 + 6 && finLigne[-1] == '\n');
+    assert(formaterResultatCsv(pire, tampon, tampon + 100) == tampon);
+}
+
+void testReplicationsParalleles() {
+    genererFichierProduits("test_produits.txt");
+    GestionDonnees donnees;
+    const bool chargementDonnees = donnees.lireProduits("test_produits.txt");
+    assert(chargementDonnees);
+    genererNuageVilles(donnees, 60, 9, 100.0);
+
+    const int nbReplications = 40;
+    std::remove("test_replications.txt");
+    AlgorithmesGloutonsRandomises algo(donnees, 0);
+    int effectuees = 0;
+    {
+        PuitsResultats puits("test_replications.txt");
+        effectuees = executerReplications(algo, donnees, nbReplications, 4, puits);
+        const bool ecritureResultats = puits.terminer();
+        assert(ecritureResultats);
+    }
+    assert(effectuees == nbReplications);
+
+    // Chaque graine exactement une fois ; les meilleurs scores sont les maxima des lignes écrites
+    std::vector<int> vues(nbReplications + 1, 0);
+    double maxP1 = -std::numeric_limits<double>::infinity(), maxP2 = maxP1;
+    std::ifstream fin("test_replications.txt");
+    std::string ligne;
+    while (std::getline(fin, ligne)) {
+        std::istringstream champs(ligne);
+        std::string graine, benefice, energie, score;
+        std::getline(champs, graine, ',');
+        std::getline(champs, benefice, ',');
+        std::getline(champs, energie, ',');
+        std::getline(champs, score, ',');
+        const int g = std::stoi(graine);
+        assert(g >= 1 && g <= nbReplications);
+        ++vues[g];
+        maxP1 = std::max(maxP1, std::stod(benefice));
+        maxP2 = std::max(maxP2, std::stod(score));
+    }
+    assert(std::count(vues.begin() + 1, vues.end(), 1) == nbReplications);
+    assert(algo.getMeilleurScoreP1() == maxP1 && algo.getMeilleurScoreP2() == maxP2);
+
+    double beneficeMeilleur = 0.0;
+    for (const auto& p : algo.getMeilleureSolutionP1()) beneficeMeilleur += p.valeur;
+    assert(beneficeMeilleur == maxP1);
+    assert(algo.getMeilleureSolutionP2().size() == donnees.villes.size());
+}
+
+void testCacheInstances() {
+    genererFichierProduits("test_cache_produits.txt");
+    genererFichierVilles("test_cache_villes.txt");
+
+    auto premiere = CacheInstances::global().obtenir("test_cache_produits.txt", "test_cache_villes.txt");
+    auto seconde = CacheInstances::global().obtenir("test_cache_produits.txt", "test_cache_villes.txt");
+    assert(premiere && premiere == seconde);
+
+    // Un fichier modifié (taille différente) invalide l'entrée
+    std::ofstream fout("test_cache_produits.txt", std::ios::app);
+    fout << "\n";
+    fout.close();
+    auto rechargee = CacheInstances::global().obtenir("test_cache_produits.txt", "test_cache_villes.txt");
+    assert(rechargee && rechargee != premiere && rechargee->produits.size() == 5);
+}
+
+
 //Q10**
 void genererGrandFichierProduits(const std::string& fichier, int nbProduits) {
     std::ofstream fout(fichier);
@@ -443,7 +4043,7 @@ void genererGrandFichierProduits(const std::string& fichier, int nbProduits) {
     std::uniform_real_distribution<> poidsDist(1.0, 20.0);
     std::uniform_real_distribution<> valeurDist(1.0, 50.0);
 
-    fout << nbProduits << ";1000.0\n";  // Capacit fixe  1000
+    fout << nbProduits << ";1000.0\n";  // Capacité fixée à 1000
     for (int i = 1; i <= nbProduits; ++i) {
         double poids = poidsDist(gen);
         double valeur = valeurDist(gen);
@@ -452,6 +4052,19 @@ void genererGrandFichierProduits(const std::string& fichier, int nbProduits) {
     fout.close();
 }
 
+void genererGrandFichierVillesCoordonnees(const std::string& fichier, int nbVilles) {
+    std::ofstream fout(fichier);
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_real_distribution<> dist(0.0, 1000.0);
+
+    fout << nbVilles << " xy\n";
+    for (int i = 0; i < nbVilles; ++i) {
+        fout << "Ville_" << i << ";" << dist(gen) << ";" << dist(gen) << "\n";
+    }
+    fout.close();
+}
+
 void genererGrandFichierVilles(const std::string& fichier, int nbVilles) {
     std::ofstream fout(fichier);
     std::random_device rd;
@@ -473,10 +4086,63 @@ void genererGrandFichierVilles(const std::string& fichier, int nbVilles) {
     fout.close();
 }
 
+// Matrice de plusieurs blocs de lignes : même résultat qu'une lecture séquentielle par flux, quel que
+// soit le nombre de threads, et la première erreur (dans l'ordre des lignes) est celle signalée
+void testLectureMatriceParallele() {
+    const int n = 200;
+    genererGrandFichierVilles("test_grande_matrice.txt", n);
+
+    std::ifstream fin("test_grande_matrice.txt");
+    std::string ligne;
+    std::getline(fin, ligne);
+    for (int i = 0; i < n; ++i) std::getline(fin, ligne);
+    std::vector<std::string> lignesMatrice(n);
+    std::vector<double> attendue(static_cast<size_t>(n) * n);
+    for (int i = 0; i < n; ++i) {
+        std::getline(fin, lignesMatrice[i]);
+        std::istringstream iss(lignesMatrice[i]);
+        for (int j = 0; j < n; ++j) iss >> attendue[static_cast<size_t>(i) * n + j];
+    }
+    fin.close();
+
+    for (unsigned int nbThreads : { 1u, 4u }) {
+        GestionDonnees donnees;
+        donnees.nbThreadsChargement = nbThreads;
+        const bool chargementDonnees = donnees.lireVilles("test_grande_matrice.txt");
+        assert(chargementDonnees);
+        for (int i = 0; i < n; ++i) {
+            assert(std::equal(attendue.begin() + static_cast<size_t>(i) * n, attendue.begin() + static_cast<size_t>(i + 1) * n, donnees.energie().ligne(i)));
+        }
+    }
+
+    // Valeurs négatives dans deux blocs différents : la ligne 40 est signalée
+    for (int i : { 150, 40 }) {
+        std::istringstream iss(lignesMatrice[i]);
+        std::ostringstream oss;
+        std::string valeur;
+        for (int j = 0; iss >> valeur; ++j) oss << (j == 7 ? "-1" : valeur) << " ";
+        lignesMatrice[i] = oss.str();
+    }
+    std::ofstream fout("test_grande_matrice.txt");
+    fout << n << "\n";
+    for (int i = 0; i < n; ++i) fout << "Ville_" << i << "\n";
+    for (const auto& l : lignesMatrice) fout << l << "\n";
+    fout.close();
+
+    std::ostringstream erreurs;
+    std::streambuf* cerrOriginal = std::cerr.rdbuf(erreurs.rdbuf());
+    GestionDonnees donnees;
+    donnees.nbThreadsChargement = 4;
+    const bool chargementDonnees = donnees.lireVilles("test_grande_matrice.txt");
+    std::cerr.rdbuf(cerrOriginal);
+    assert(!chargementDonnees);
+    assert(erreurs.str().find("(ligne " + std::to_string(n + 40 + 2) + ", colonne 8)") != std::string::npos);
+}
+
 
 //Q12****
 void benchmark(int nbReplications, int nbProduits, int nbVilles) {
-    // Gnration des fichiers
+    // Génération des fichiers
     genererGrandFichierProduits("bench_produits.txt", nbProduits);
     genererGrandFichierVilles("bench_villes.txt", nbVilles);
 
@@ -497,15 +4163,15 @@ void benchmark(int nbReplications, int nbProduits, int nbVilles) {
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
 
     std::cout << "Benchmark pour " << nbProduits << " produits et " << nbVilles << " villes:\n";
-    std::cout << "Temps total pour " << nbReplications << " rplications: " << duration.count() << " ms\n";
-    std::cout << "Temps moyen par rplication: " << duration.count() / nbReplications << " ms\n";
+    std::cout << "Temps total pour " << nbReplications << " réplications: " << duration.count() << " ms\n";
+    std::cout << "Temps moyen par réplication: " << duration.count() / nbReplications << " ms\n";
 }
 
 void construireNouvelleSolution(const AlgorithmesGloutonsRandomises& algo, const GestionDonnees& donnees) {
     std::cout << "=== Nouvelle Solution ===" << std::endl;
 
     // Afficher la meilleure solution pour P1
-    std::cout << "Meilleure solution pour P1 (Sac  dos) : " << std::endl;
+    std::cout << "Meilleure solution pour P1 (Sac à dos) : " << std::endl;
     for (const auto& produit : algo.getMeilleureSolutionP1()) {
         std::cout << "  - ID: " << produit.id
             << ", Poids: " << produit.poids
@@ -514,7 +4180,7 @@ void construireNouvelleSolution(const AlgorithmesGloutonsRandomises& algo, const
     }
 
     // Afficher la meilleure solution pour P2
-    std::cout << "Meilleure solution pour P2 (Tourne) : " << std::endl;
+    std::cout << "Meilleure solution pour P2 (Tournée) : " << std::endl;
     for (int villeId : algo.getMeilleureSolutionP2()) {
         std::cout << "  - Ville ID: " << villeId
             << " (" << donnees.villes[villeId].nom << ")" << std::endl;
@@ -525,15 +4191,141 @@ void construireNouvelleSolution(const AlgorithmesGloutonsRandomises& algo, const
     std::cout << "Score P2 : " << algo.getMeilleurScoreP2() << std::endl;
 }
 
+// Options "--nom=valeur" (chargement des instances, format des résultats), utilisables avec tous les modes
+struct OptionsLigneCommande {
+    ModeStockage stockage = ModeStockage::Dense;
+    Precision precision = Precision::Double;
+    FormatResultats formatResultats = FormatResultats::Csv;
+    ParametresResolution resolution;
+
+    void appliquer(GestionDonnees& donnees) const {
+        donnees.modeStockage = stockage;
+        donnees.precision = precision;
+    }
+};
+
+// Valeur numérique d'une option "--nom=<x>" ; false si elle n'est pas un nombre
+bool lireValeurOption(const std::string& option, size_t debut, double& valeur) {
+    try {
+        valeur = std::stod(option.substr(debut));
+    }
+    catch (...) {
+        return false;
+    }
+    return true;
+}
+
+bool lireOption(const std::string& option, OptionsLigneCommande& options) {
+    if (option == "--stockage=dense") options.stockage = ModeStockage::Dense;
+    else if (option == "--stockage=triangulaire") options.stockage = ModeStockage::Triangulaire;
+    else if (option == "--stockage=auto") options.stockage = ModeStockage::Auto;
+    else if (option == "--precision=double") options.precision = Precision::Double;
+    else if (option == "--precision=float") options.precision = Precision::Float;
+    else if (option == "--precision=16bits") options.precision = Precision::Quantifie16;
+    else if (option == "--resultats=csv") options.formatResultats = FormatResultats::Csv;
+    else if (option == "--resultats=binaire") options.formatResultats = FormatResultats::Binaire;
+    else if (option == "--sac=glouton") options.resolution.solveurSac = SolveurSac::Glouton;
+    else if (option == "--sac=exact") options.resolution.solveurSac = SolveurSac::Exact;
+    else if (option == "--sac=bb") options.resolution.solveurSac = SolveurSac::BranchAndBound;
+    else if (option == "--sac=noyau") options.resolution.solveurSac = SolveurSac::Noyau;
+    else if (option == "--amelioration-sac=oui") options.resolution.rechercheLocaleSac = true;
+    else if (option == "--amelioration-sac=non") options.resolution.rechercheLocaleSac = false;
+    else if (option == "--amelioration-tournee=oui") options.resolution.rechercheLocaleTournee = true;
+    else if (option == "--amelioration-tournee=non") options.resolution.rechercheLocaleTournee = false;
+    else if (option == "--liste=blocs") options.resolution.listeRestreinte = ListeRestreinte::Blocs;
+    else if (option == "--liste=cardinalite") options.resolution.listeRestreinte = ListeRestreinte::Cardinalite;
+    else if (option == "--liste=valeur") options.resolution.listeRestreinte = ListeRestreinte::Valeur;
+    else if (option == "--alpha=reactif") options.resolution.alphaReactif = true;
+    else if (option.rfind("--temps-sac=", 0) == 0) {
+        return lireValeurOption(option, 12, options.resolution.limiteTempsSac) && options.resolution.limiteTempsSac > 0;
+    }
+    else if (option.rfind("--echelle=", 0) == 0) {
+        return lireValeurOption(option, 10, options.resolution.echelleSac) && options.resolution.echelleSac > 0;
+    }
+    else if (option.rfind("--lk=", 0) == 0) {
+        return lireValeurOption(option, 5, options.resolution.tempsLK) && options.resolution.tempsLK > 0;
+    }
+    else if (option.rfind("--held-karp=", 0) == 0) {
+        double villes = 0;
+        if (!lireValeurOption(option, 12, villes) || villes < 0 || villes > VILLES_MAX_HELD_KARP) return false;
+        options.resolution.villesMaxHeldKarp = static_cast<int>(villes);
+    }
+    else if (option.rfind("--borne=", 0) == 0) {
+        double iterations = 0;
+        if (!lireValeurOption(option, 8, iterations) || iterations < 0) return false;
+        options.resolution.iterationsBorne = static_cast<int>(iterations);
+    }
+    else if (option.rfind("--ecart-arret=", 0) == 0) {
+        return lireValeurOption(option, 14, options.resolution.ecartArret) && options.resolution.ecartArret >= 0;
+    }
+    else if (option.rfind("--alpha=", 0) == 0) {
+        double& alpha = options.resolution.alpha;
+        return lireValeurOption(option, 8, alpha) && alpha >= 0 && alpha <= 1;
+    }
+    else if (option.rfind("--taille-liste=", 0) == 0) {
+        double taille = 0;
+        if (!lireValeurOption(option, 15, taille) || taille < 1) return false;
+        options.resolution.tailleListe = static_cast<int>(taille);
+    }
+    else if (option.rfind("--iterations-grasp=", 0) == 0) {
+        double iterations = 0;
+        if (!lireValeurOption(option, 19, iterations) || iterations < 1) return false;
+        options.resolution.iterationsGrasp = static_cast<int>(iterations);
+    }
+    else return false;
+    return true;
+}
+
 int main(int argc, char* argv[]) {
     // Tests
     testLectureFichiers();
+    testLectureMatriceParallele();
     testAlgorithmesGloutonsRandomises();
+    testSacADosExact();
+    testRechercheLocaleSac();
+    testGrasp();
     testReplications();
+    testFormatBinaire();
+    testStockageTriangulaire();
+    testVillesCoordonnees();
+    testVillesRestantes();
+    testListesVoisins();
+    test2Opt();
+    testOrOptAsymetrique();
+    testLinKernighan();
+    testHeldKarp();
+    testBorneTournee();
+    testPrecisionReduite();
+    testCacheInstances();
+    testPuitsResultats();
+    testReplicationsParalleles();
+
+    // Les options sont retirées des arguments, les modes ci-dessous ne voient que les arguments positionnels
+    OptionsLigneCommande options;
+    std::vector<char*> arguments;
+    for (int i = 0; i < argc; ++i) {
+        if (i > 0 && std::string(argv[i]).rfind("--", 0) == 0) {
+            if (!lireOption(argv[i], options)) {
+                std::cerr << "Erreur: Option inconnue " << argv[i] << std::endl;
+                return 1;
+            }
+            continue;
+        }
+        arguments.push_back(argv[i]);
+    }
+    argc = static_cast<int>(arguments.size());
+    argv = arguments.data();
 
-    if (argc < 3 || argc > 4) {
+    const std::string mode = (argc > 1) ? argv[1] : "";
+    const bool sousCommande = (mode == "script" || mode == "convert" || mode == "replicate");
+    if (!sousCommande && (argc < 3 || argc > 4)) {
         std::cerr << "Usage: " << argv[0] << " <fichier_produits> <fichier_villes> [graine]" << std::endl;
-        std::cerr << "Ou pour gnrer un script: " << argv[0] << " script <nb_replications> <fichier_produits> <fichier_villes>" << std::endl;
+        std::cerr << "Ou pour générer un script: " << argv[0] << " script <nb_replications> <fichier_produits> <fichier_villes>" << std::endl;
+        std::cerr << "Ou pour convertir en binaire: " << argv[0] << " convert <fichier_produits> <fichier_villes> <sortie_produits> <sortie_villes>" << std::endl;
+        std::cerr << "Ou pour des réplications en parallèle: " << argv[0] << " replicate <nb_replications> <nb_threads> <fichier_produits> <fichier_villes>" << std::endl;
+        std::cerr << "Options: --stockage=dense|triangulaire|auto --precision=double|float|16bits --resultats=csv|binaire --sac=glouton|exact|bb|noyau --echelle=<x> --temps-sac=<s> --amelioration-sac=oui|non --amelioration-tournee=oui|non" << std::endl;
+        std::cerr << "         --liste=blocs|cardinalite|valeur --taille-liste=<k> --alpha=<a>|reactif --iterations-grasp=<n> --lk=<s> --held-karp=<n> (0 par défaut)" << std::endl;
+        std::cerr << "         --borne=<iterations> (0 par défaut : pas de borne) --ecart-arret=<x> (avec --borne)" << std::endl;
         return 1;
     }
 
@@ -549,7 +4341,66 @@ int main(int argc, char* argv[]) {
         std::string fichierVilles = argv[4];
         genererScriptLinux(nbReplications, argv[0], fichierProduits, fichierVilles);
         genererScriptWindows(nbReplications, argv[0], fichierProduits, fichierVilles);
-        std::cout << "Scripts gnrs : replications.sh (Linux) et replications.bat (Windows)" << std::endl;
+        std::cout << "Scripts générés : replications.sh (Linux) et replications.bat (Windows)" << std::endl;
+        return 0;
+    }
+
+    if (mode == "convert") {
+        if (argc != 6) {
+            std::cerr << "Usage: " << argv[0] << " convert <fichier_produits> <fichier_villes> <sortie_produits> <sortie_villes>" << std::endl;
+            return 1;
+        }
+        GestionDonnees donnees;
+        options.appliquer(donnees);
+        if (!donnees.lireProduits(argv[2]) || !donnees.lireVilles(argv[3])) {
+            return 1;
+        }
+        if (!donnees.ecrireProduitsBinaire(argv[4]) || !donnees.ecrireVillesBinaire(argv[5])) {
+            return 1;
+        }
+        std::cout << "Fichiers binaires générés : " << argv[4] << " et " << argv[5] << std::endl;
+        return 0;
+    }
+
+    if (mode == "replicate") {
+        if (argc != 6) {
+            std::cerr << "Usage: " << argv[0] << " replicate <nb_replications> <nb_threads> <fichier_produits> <fichier_villes>" << std::endl;
+            return 1;
+        }
+        int nbReplications = std::stoi(argv[2]);
+        unsigned int nbThreads = static_cast<unsigned int>(std::stoul(argv[3]));
+        auto instance = CacheInstances::global().obtenir(argv[4], argv[5], options.stockage, options.precision);
+        if (!instance || nbReplications <= 0) {
+            return 1;
+        }
+
+        AlgorithmesGloutonsRandomises algo(*instance, 0);
+        algo.parametres = options.resolution;
+        if (options.resolution.ecartArret > 0.0 && options.resolution.iterationsBorne <= 0) {
+            std::cerr << "Erreur: --ecart-arret demande une borne (--borne=<iterations>)" << std::endl;
+            return 1;
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        algo.calculerBorneTournee(nbThreads);
+        int effectuees = 0;
+        {
+            PuitsResultats puits(fichierResultats(options.formatResultats), options.formatResultats);
+            if (!puits.ouvert()) {
+                return 1;
+            }
+            effectuees = executerReplications(algo, *instance, nbReplications, nbThreads, puits);
+            if (!puits.terminer()) {
+                std::cerr << "Erreur: Écriture des résultats dans " << fichierResultats(options.formatResultats) << " incomplète" << std::endl;
+                return 1;
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        std::cout << effectuees << " réplications en " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()
+            << " ms (résultats dans " << fichierResultats(options.formatResultats) << ")" << std::endl;
+        std::cout << "Meilleur score P1 : " << algo.getMeilleurScoreP1() << std::endl;
+        std::cout << "Meilleur score P2 : " << algo.getMeilleurScoreP2() << std::endl;
+        if (algo.borneTournee > 0.0) std::cout << "Borne inférieure de l'énergie : " << algo.borneTournee << std::endl;
         return 0;
     }
 
@@ -558,26 +4409,40 @@ int main(int argc, char* argv[]) {
     unsigned int graine = (argc == 4) ? static_cast<unsigned int>(std::stoul(argv[3])) : std::random_device{}();
 
     GestionDonnees donnees;
+    options.appliquer(donnees);
     if (!donnees.lireProduits(fichierProduits) || !donnees.lireVilles(fichierVilles)) {
         return 1;
     }
 
     AlgorithmesGloutonsRandomises algo(donnees, graine);
-    auto sac = algo.resoudreSacADosRandomise();
-    auto tournee = algo.resoudreTourneeRandomisee();
+    algo.parametres = options.resolution;
+    auto sac = algo.resoudreSacADos();
+    auto tournee = algo.resoudreTournee();
     auto resultats = algo.calculerResultats(sac, tournee);
     double benefice = resultats.first;
     double energie = resultats.second;
 
-    std::cout << "=== Rsultats pour la graine " << graine << " ===" << std::endl;
-    std::cout << "Bnfice total : " << benefice << std::endl;
-    std::cout << "nergie totale : " << energie << std::endl;
-    std::cout << "Score (Bnfice - nergie) : " << (benefice - energie) << std::endl;
+    std::cout << "=== Résultats pour la graine " << graine << " ===" << std::endl;
+    std::cout << "Bénéfice total : " << benefice << std::endl;
+    std::cout << "Énergie totale : " << energie << std::endl;
+    std::cout << "Score (Bénéfice - Énergie) : " << (benefice - energie) << std::endl;
+    algo.borneTournee = algo.borneInferieureTournee(energie, options.resolution.iterationsBorne, 0u);
+    if (algo.borneTournee > 0.0) {
+        std::cout << "Borne inférieure de l'énergie : " << algo.borneTournee << ", écart : "
+            << 100.0 * AlgorithmesGloutonsRandomises::ecartBorne(energie, algo.borneTournee) << " %" << std::endl;
+    }
+    if (options.resolution.solveurSac == SolveurSac::BranchAndBound || options.resolution.solveurSac == SolveurSac::Noyau) {
+        const ResultatSacExact& r = algo.dernierSacExact;
+        std::cout << "P1 " << (r.optimal ? "optimal" : "non prouvé optimal") << " (" << r.noeuds << " noeuds), borne supérieure : "
+            << r.borneSuperieure << ", écart : " << 100.0 * r.ecart << " %" << std::endl;
+    }
 
     if (argc == 3) {
-        std::ofstream resultatsFichier("resultats.txt", std::ios::app);
-        resultatsFichier << graine << "," << benefice << "," << energie << "," << (benefice - energie) << std::endl;
-        resultatsFichier.close();
+        PuitsResultats puits(fichierResultats(options.formatResultats), options.formatResultats);
+        puits.ajouter({ graine, 0, benefice, energie, benefice - energie, algo.borneTournee, AlgorithmesGloutonsRandomises::ecartBorne(energie, algo.borneTournee) });
+        if (!puits.terminer()) {
+            return 1;
+        }
     }
 
     return 0;